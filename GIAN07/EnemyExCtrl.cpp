@@ -9,6 +9,7 @@
 #include "MAID.H"
 #include "platform/graphics_backend.h"
 #include "game/cast.h"
+#include "game/snapshot.h"
 #include "game/snd.h"
 #include "game/ut_math.h"
 
@@ -18,6 +19,9 @@
 SNAKYMOVE_DATA<30> SnakeData[SNAKE_MAX];
 BIT_DATA		BitData;
 
+// SNAKYMOVE_DATA::Parent points into Boss[], and therefore stays valid.
+static const SNAPSHOT_STATE EnemyExState = { SnakeData, BitData };
+
 
 static void BitSTDRoll(void);	// 基本的なビット回転処理
 static void BitSTDRad(void);	// 基本的な半径処理
@@ -64,7 +68,7 @@ void SnakySet(BOSS_DATA *b, int len, uint32_t TailID)
 
 	const auto n = (4 + (TailID << 2));
 	for(auto& enemy_ptr : s->EnemyPtr) {
-		if(EnemyNow+1<ENEMY_MAX){
+		if(EnemyNow+1u<Enemy.size()){
 			e = &Enemy[EnemyInd[EnemyNow++]];
 
 			InitEnemyDataX64(e,b->Edat.x,b->Edat.y,n);
@@ -212,7 +216,7 @@ void BitSet(BOSS_DATA *b, uint8_t NumBits, uint32_t BitID)
 	const auto n = (4 + (BitID << 2));
 
 	for(i=0; i<NumBits; i++){
-		if(EnemyNow+1 < ENEMY_MAX){
+		if((EnemyNow + 1u) < Enemy.size()){
 			// 敵資源の要求 //
 			auto* e = &Enemy[EnemyInd[EnemyNow++]];
 
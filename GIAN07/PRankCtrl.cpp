@@ -6,9 +6,15 @@
 #include "PRankCtrl.h"
 #include "LEVEL.H"
 #include "GIAN.H"
+#include "game/snapshot.h"
 
 PlayRankInfo	PlayRank;
 
+static const SNAPSHOT_STATE PlayRankState = { PlayRank };
+static const SNAPSHOT_HASH PlayRankHash = { u8"PlayRank", [](STATE_HASH& h) {
+	h.Add(PlayRank.GameLevel, PlayRank.Rank);
+} };
+
 
 
 // 難易度の許容範囲内でプレイランクを増減する
@@ -332,12 +332,14 @@ WINDOW_MENU Menu = { std::span(InpKey), SetItem };
 
 static void FnMsgSkip(int_fast8_t delta);
 static void FnZSpeedDown(int_fast8_t delta);
+static void FnRunAhead(int_fast8_t delta);
 static void SetItem(bool tick = true);
 
-char Title[2][23];
+char Title[3][23];
 WINDOW_CHOICE Item[] = {
 	{ Title[0], "弾キーのメッセージスキップ設定", FnMsgSkip },
 	{ Title[1], "弾キーの押しっぱなしで低速移動", FnZSpeedDown },
+	{ Title[2], "先読みで入力の遅延を軽減します", FnRunAhead },
 	{ "Joy Pad", "パッドの設定をします", Pad::Menu },
 	SubmenuExitItemForArray,
 };
@@ -791,6 +793,11 @@ static void Main::Cfg::Inp::FnZSpeedDown(int_fast8_t)
 	}
 }
 
+static void Main::Cfg::Inp::FnRunAhead(int_fast8_t delta)
+{
+	RingStep(ConfigDat.RunAhead.v, delta, 0, RUNAHEAD_MAX);
+}
+
 
 static bool RFnStg(int stage, INPUT_BITS key)
 {
@@ -1114,7 +1121,7 @@ static void Main::Cfg::Grp::Screenshot::SetItem(bool)
 			MainWindow.Select[MainWindow.SelectDepth] == (2 + i)
 		);
 		const auto format = format_for(i, ALIGN::LEFT);
-		const auto time = Grp_ScreenshotTimes[i];
+		const auto time = Grp_ScreenshotTimes[i].load();
 		EnumFlagSet(item.Flags, WINDOW_FLAGS::HIGHLIGHT, (i == effort));
 		if(time < 0s) {
 			sprintf(TitlePerf[i], "%s[  FAILED  ]", format);
@@ -1258,6 +1265,11 @@ static void Main::Cfg::Inp::SetItem(bool)
 
 	sprintf(Title[0], "Z-MessageSkip[%s]", (skip ? "ＯＫ" : "禁止"));
 	sprintf(Title[1], "Z-SpeedDown  [%s]", (down ? "ＯＫ" : "禁止"));
+	if(ConfigDat.RunAhead.v == 0) {
+		sprintf(Title[2], "Run-Ahead    [ OFF]");
+	} else {
+		sprintf(Title[2], "Run-Ahead    [%d fr]", ConfigDat.RunAhead.v);
+	}
 }
 
 static void Main::Cfg::Inp::Pad::SetItem(bool)
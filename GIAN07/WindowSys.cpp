@@ -8,6 +8,7 @@
 #include "FONTUTY.H"
 #include "platform/text_backend.h"
 #include "game/enum_flags.h"
+#include "game/snapshot.h"
 #include "game/snd.h"
 #include "game/ut_math.h"
 
@@ -64,6 +65,17 @@ static void GrpBoxA2(int x1,int y1,int x2,int y2);			// 平行四辺形ＢＯＸ
 
 MSG_WINDOW		MsgWindow;		// メッセージウィンドウ
 
+// Only covers the animation state advanced by MWinMove(). The text can only
+// change through SCL commands, which are never run during speculative frames.
+static const SNAPSHOT_STATE MsgWindowState = {
+	MsgWindow.NowSize,
+	MsgWindow.State,
+	MsgWindow.FaceID,
+	MsgWindow.NextFace,
+	MsgWindow.FaceState,
+	MsgWindow.FaceTime,
+};
+
 
 
 uint8_t WINDOW_MENU::MaxItems() const
@@ -87,12 +99,22 @@ void WINDOW_SYSTEM::Init(PIXEL_COORD w)
 	W = w;
 	Parent.SetItems(true);
 
+	// Give the space back before registering again, so that reopening a
+	// window doesn't keep growing the text surface.
+	if(TRRGeneration == TextObj.Generation()) {
+		for(const auto trr : std::span(TRRs, TRRCount)) {
+			TextObj.Free(trr);
+		}
+	}
+
 	// Don't forget the header.
 	const auto max_items = (1 + Parent.MaxItems());
 
 	for(auto i = 0; i < max_items; i++) {
 		TRRs[i] = TextObj.Register({ W, CWIN_ITEM_H });
 	}
+	TRRCount = Cast::down_sign<uint8_t>(max_items);
+	TRRGeneration = TextObj.Generation();
 }
 
 void WINDOW_SYSTEM::Open(WINDOW_POINT topleft, int select)
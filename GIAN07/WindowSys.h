@@ -224,8 +224,11 @@ typedef struct tagWINDOW_SYSTEM{
 	bool	FirstWait;	// 最初のキー解放待ち
 
 	TEXTRENDER_RECT_ID	TRRs[1 + WINITEM_MAX]; // Initialized by Init().
+	uint8_t	TRRCount = 0;	// Number of valid entries in [TRRs]
+	uint32_t	TRRGeneration = 0;	// TextObj.Generation() during Init()
 
-	// Prepares text rendering for a window with the given width.
+	// Prepares text rendering for a window with the given width. Frees the
+	// rectangles of any previous call, unless TextObj was cleared since.
 	void Init(PIXEL_COORD w);
 
 	// コマンドウィンドウの初期化 //
@@ -0,0 +1,136 @@
+/*
+ *   Generic entity management
+ *
+ */
+
+#include "GIAN07/entity.h"
+#include "game/debug.h"
+#include "game/string_format.h"
+
+// Function-local to sidestep the static initialization order of the
+// ENTITY_POOL objects in other translation units.
+static std::vector<ENTITY_POOL *>& Pools(void)
+{
+	static std::vector<ENTITY_POOL *> ret;
+	return ret;
+}
+
+ENTITY_POOL::ENTITY_POOL(
+	const char8_t *name,
+	uint16_t capacity_default,
+	void (*allocate)(uint16_t capacity)
+) :
+	name(name),
+	capacity_default(capacity_default),
+	capacity(capacity_default),
+	allocate(allocate)
+{
+	Pools().emplace_back(this);
+}
+
+// Returns the pool and capacity named by a `<pool name>=<capacity>` spec.
+static std::optional<std::pair<ENTITY_POOL *, uint16_t>> CapacityParse(
+	std::u8string_view spec
+)
+{
+	const auto sep = spec.find(u8'=');
+	if(sep == std::u8string_view::npos) {
+		return std::nullopt;
+	}
+	const auto name = spec.substr(0, sep);
+	const auto num = spec.substr(sep + 1);
+
+	// Every setter function keeps one slot free, see Indsort().
+	uint16_t capacity = 0;
+	const auto* first = std::bit_cast<const char *>(num.data());
+	const auto* last = (first + num.size());
+	const auto [ptr, ec] = std::from_chars(first, last, capacity);
+	if((ec != std::errc{}) || (ptr != last) || (capacity < 2)) {
+		return std::nullopt;
+	}
+
+	for(auto* pool : Pools()) {
+		if(name == pool->name) {
+			return std::pair{ pool, capacity };
+		}
+	}
+	return std::nullopt;
+}
+
+bool Entity_SetCapacity(std::u8string_view spec)
+{
+	const auto parsed = CapacityParse(spec);
+	if(!parsed) {
+		return false;
+	}
+	const auto [pool, capacity] = parsed.value();
+	pool->capacity = capacity;
+	return true;
+}
+
+std::u8string Entity_CapacitySpecs(void)
+{
+	std::u8string ret;
+	for(const auto* pool : Pools()) {
+		if(pool->capacity == pool->capacity_default) {
+			continue;
+		}
+		ret += pool->name;
+		ret += u8'=';
+		StringCatNum<0>(pool->capacity, ret);
+		ret += u8'\n';
+	}
+	return ret;
+}
+
+bool Entity_CapacitySpecsMatch(std::u8string_view specs)
+{
+	std::vector<const ENTITY_POOL *> named;
+	for(const auto line : std::views::split(specs, u8'\n')) {
+		const auto spec = std::u8string_view{ line.begin(), line.end() };
+		if(spec.empty()) {
+			continue;
+		}
+		const auto parsed = CapacityParse(spec);
+		if(!parsed) {
+			return false;
+		}
+		const auto [pool, capacity] = parsed.value();
+		if(pool->capacity != capacity) {
+			return false;
+		}
+		named.emplace_back(pool);
+	}
+	return std::ranges::all_of(Pools(), [&](const ENTITY_POOL *pool) {
+		return (
+			std::ranges::contains(named, pool) ||
+			(pool->capacity == pool->capacity_default)
+		);
+	});
+}
+
+void Entity_Allocate(void)
+{
+	for(auto* pool : Pools()) {
+		pool->allocate(pool->capacity);
+	}
+}
+
+void Entity_LogHighWater(void)
+{
+	std::u8string line;
+	for(const auto* pool : Pools()) {
+		line = u8"Entity pool ";
+		line += pool->name;
+		line += u8": ";
+		StringCatNum<0>(pool->high_water, line);
+		line += u8" / ";
+		StringCatNum<0>(pool->capacity, line);
+		if(pool->capacity != pool->capacity_default) {
+			line += u8" (default ";
+			StringCatNum<0>(pool->capacity_default, line);
+			line += u8")";
+		}
+		DebugLog(line);
+	}
+}
@@ -8,13 +8,158 @@
 import std.compat;
 #include <assert.h>
 
-template <class T, size_t N, typename ShouldDelete> void Indsort(
-	std::array<uint16_t, N>& indices,
+// Runtime capacities
+// ------------------
+// Every pooled entity type has a capacity that defaults to the limit of the
+// original game, but can be changed once at startup, before
+// Entity_Allocate(). Replays only stay in sync if they are played back with
+// the same capacities they were recorded with, so they store all non-default
+// ones, and refuse to load under any other capacities.
+
+// Heap-allocated replacement for a fixed-size global array.
+template <class T> class ENTITY_ARRAY {
+	std::unique_ptr<T[]> buf;
+	size_t count = 0;
+
+public:
+	// Value-initializes all elements, just like a zero-initialized global
+	// array.
+	void Allocate(size_t n) {
+		buf = std::make_unique<T[]>(n);
+		count = n;
+	}
+
+	T& operator[](size_t i) {
+		assert(i < count);
+		return buf[i];
+	}
+	const T& operator[](size_t i) const {
+		assert(i < count);
+		return buf[i];
+	}
+
+	T* data() { return buf.get(); }
+	const T* data() const { return buf.get(); }
+	size_t size() const { return count; }
+	T* begin() { return buf.get(); }
+	T* end() { return (buf.get() + count); }
+	const T* begin() const { return buf.get(); }
+	const T* end() const { return (buf.get() + count); }
+};
+
+// Bit set of the active slots in an ENTITY_ARRAY. Spawning and despawning are
+// O(1), and iteration only visits active slots, in ascending order. This keeps
+// the order of any RNG calls identical to a linear scan over the whole array.
+class ENTITY_ACTIVE_SET {
+	ENTITY_ARRAY<uint64_t> words;
+	size_t capacity = 0;
+
+public:
+	// Clears all slots.
+	void Allocate(size_t n) {
+		words.Allocate((n + 63) / 64);
+		capacity = n;
+	}
+
+	void Clear() {
+		std::ranges::fill(words, 0);
+	}
+
+	void Set(size_t i, bool active) {
+		assert(i < capacity);
+		auto& word = words[i / 64];
+		const auto bit = (uint64_t{ 1 } << (i % 64));
+		word = (active ? (word | bit) : (word & ~bit));
+	}
+
+	bool Test(size_t i) const {
+		assert(i < capacity);
+		return ((words[i / 64] >> (i % 64)) & 1);
+	}
+
+	// Returns the first inactive slot at or after [from].
+	std::optional<size_t> FirstFree(size_t from = 0) const {
+		for(size_t w = (from / 64); w < words.size(); w++) {
+			auto free = ~words[w];
+			if(w == (from / 64)) {
+				free &= (~uint64_t{ 0 } << (from % 64));
+			}
+			if(free) {
+				const auto i = ((w * 64) + std::countr_zero(free));
+				return ((i < capacity) ? std::optional{ i } : std::nullopt);
+			}
+		}
+		return std::nullopt;
+	}
+
+	// Calls [func] with the index of every active slot. [func] may deactivate
+	// the slot it was called with.
+	void ForEach(std::invocable<size_t> auto&& func) const {
+		for(size_t w = 0; w < words.size(); w++) {
+			for(auto bits = words[w]; bits; bits &= (bits - 1)) {
+				func((w * 64) + std::countr_zero(bits));
+			}
+		}
+	}
+
+	// The underlying storage, for registering with SNAPSHOT_STATE.
+	ENTITY_ARRAY<uint64_t>& Words() {
+		return words;
+	}
+};
+
+struct ENTITY_POOL {
+	const char8_t *const name;
+	const uint16_t capacity_default;
+	uint16_t capacity;
+
+	// Highest number of simultaneously active entities seen during this run.
+	uint16_t high_water = 0;
+
+	// Allocates all arrays of this entity type for the given capacity.
+	void (*const allocate)(uint16_t capacity);
+
+	ENTITY_POOL(
+		const char8_t *name,
+		uint16_t capacity_default,
+		void (*allocate)(uint16_t capacity)
+	);
+
+	void Track(size_t active) {
+		if(active > high_water) {
+			high_water = static_cast<uint16_t>(active);
+		}
+	}
+};
+
+// Parses and applies a `<pool name>=<capacity>` override. Returns `false` if
+// the pool doesn't exist or the capacity is invalid.
+bool Entity_SetCapacity(std::u8string_view spec);
+
+// Returns all capacities that differ from their default, as newline-terminated
+// specs in the format accepted by Entity_SetCapacity().
+std::u8string Entity_CapacitySpecs(void);
+
+// Returns whether the current capacities are exactly the ones described by
+// [specs], as returned by Entity_CapacitySpecs(), with all other pools at
+// their default.
+bool Entity_CapacitySpecsMatch(std::u8string_view specs);
+
+// Allocates the storage of all pools with their current capacity.
+void Entity_Allocate(void);
+
+// Writes the high-water mark and capacity of every pool to the debug log.
+void Entity_LogHighWater(void);
+// ------------------
+
+template <class Indices, class Entities, typename ShouldDelete> void Indsort(
+	Indices& indices,
 	uint16_t& count,
-	const std::array<T, N>& entities,
+	const Entities& entities,
 	ShouldDelete should_delete
 )
 {
+	const auto N = indices.size();
 	uint16_t i;
 	uint16_t next;
 
@@ -0,0 +1,289 @@
+/*
+ *   Run history
+ *
+ */
+
+#include "run_history.h"
+#include "GIAN.H"
+#include "game/save.h"
+#include "game/snapshot.h"
+#include "platform/file.h"
+#include "platform/time.h"
+
+constexpr auto RUN_HISTORY_FN = u8"秋霜RUN.DAT";
+
+// Format
+// ------
+
+uint32_t RUN_RECORD::Sum(void) const
+{
+	const auto* p = reinterpret_cast<const uint8_t *>(&time_start);
+	const auto* end = reinterpret_cast<const uint8_t *>(this + 1);
+	return std::accumulate(p, end, uint32_t{ 0 });
+}
+
+bool RUN_RECORD::Valid(void) const
+{
+	return (
+		(name == RUN_HEADNAME) &&
+		(sum == Sum()) &&
+		(level <= GAME_EXTRA) &&
+		(std::to_underlying(end) < std::size(RUN_END_NAMES)) &&
+		(stage_count >= 1) &&
+		(stage_count <= stages.size())
+	);
+}
+// ------
+
+// Recording
+// ---------
+
+static struct {
+	RUN_RECORD record;
+	uint32_t graze_base;	// [Viv.evade_sum] at the start of the current stage
+	bool active;
+} Run;
+
+static const SNAPSHOT_STATE RunState = { Run };
+
+static void Saturating8Inc(uint8_t& v)
+{
+	v += (v != (std::numeric_limits<uint8_t>::max)());
+}
+
+static RUN_STAGE& RunStage(void)
+{
+	return Run.record.stages[Run.record.stage_count - 1];
+}
+
+static void RunStageStart(void)
+{
+	auto& stage = Run.record.stages[Run.record.stage_count++];
+	stage.stage = GameStage;
+	Run.graze_base = Viv.evade_sum;
+}
+
+static void RunStageEnd(void)
+{
+	auto& stage = RunStage();
+	stage.score = Viv.score;
+	stage.graze = (stage.graze + (Viv.evade_sum - Run.graze_base));
+	Run.graze_base = Viv.evade_sum;
+}
+
+void RunHistory_Start(uint8_t level)
+{
+	Run = {};
+	Run.active = true;
+	Run.record.time_start = Time_NowUnix();
+	Run.record.level = level;
+	Run.record.weapon = Viv.weapon;
+	Run.record.flags = (ConfigDat.StageSelect.v ? RUNF_PRACTICE : 0);
+	RunStageStart();
+}
+
+void RunHistory_NextStage(void)
+{
+	if(!Run.active || (Run.record.stage_count >= Run.record.stages.size())) {
+		return;
+	}
+	RunStageEnd();
+	RunStageStart();
+}
+
+void RunHistory_Bomb(void)
+{
+	if(Run.active) {
+		Saturating8Inc(RunStage().bombs);
+	}
+}
+
+void RunHistory_Miss(void)
+{
+	if(Run.active) {
+		Saturating8Inc(RunStage().misses);
+	}
+}
+
+void RunHistory_Continue(void)
+{
+	if(!Run.active) {
+		return;
+	}
+
+	// Continuing resets [Viv.evade_sum].
+	auto& stage = RunStage();
+	stage.graze = (stage.graze + (Viv.evade_sum - Run.graze_base));
+	Run.graze_base = 0;
+	Saturating8Inc(stage.continues);
+	Run.record.end = RUN_END::QUIT;
+}
+
+void RunHistory_SetEnd(RUN_END end)
+{
+	if(Run.active) {
+		Run.record.end = end;
+	}
+}
+
+void RunHistory_SetReplay(const HASH& hash)
+{
+	if(Run.active) {
+		Run.record.replay = hash;
+		Run.record.flags |= RUNF_REPLAY;
+	}
+}
+
+void RunHistory_Finish(void)
+{
+	if(!Run.active) {
+		return;
+	}
+	Run.active = false;
+	RunStageEnd();
+	Run.record.time_end = Time_NowUnix();
+	Run.record.sum = Run.record.Sum();
+	Save_Queue([record = Run.record] {
+		return File_Append(RUN_HISTORY_FN, std::span{ &record, 1 });
+	});
+}
+// ---------
+
+// Querying
+// --------
+
+std::vector<RUN_RECORD> RunHistory_Parse(BYTE_BUFFER_BORROWED buf)
+{
+	std::vector<RUN_RECORD> ret;
+	ret.reserve(buf.size() / sizeof(RUN_RECORD));
+	size_t i = 0;
+	while((buf.size() - i) >= sizeof(RUN_RECORD)) {
+		RUN_RECORD record;
+		memcpy(&record, &buf[i], sizeof(record));
+		if(record.Valid()) {
+			ret.emplace_back(record);
+			i += sizeof(RUN_RECORD);
+			continue;
+		}
+
+		// Resynchronize on the next header after a torn or corrupted record.
+		const auto rest = buf.subspan(i + 1);
+		const auto next = std::ranges::search(rest, RUN_HEADNAME).begin();
+		i += (1 + (next - rest.begin()));
+	}
+	return ret;
+}
+
+std::vector<RUN_RECORD> RunHistory_Load(void)
+{
+	Save_Wait();
+	const auto buf = SDL_LoadFile(RUN_HISTORY_FN);
+	return RunHistory_Parse({ buf.get(), buf.size() });
+}
+
+std::vector<RUN_STATS> RunHistory_Stats(std::span<const RUN_RECORD> records)
+{
+	std::vector<RUN_STATS> ret;
+	const auto key = [](const RUN_STATS& s) {
+		return std::tuple{ s.practice, s.stage, s.level, s.weapon };
+	};
+	for(const auto& record : records) {
+		const auto stages = record.Stages();
+		const RUN_STATS record_key = {
+			.stage = stages.front().stage,
+			.level = record.level,
+			.weapon = record.weapon,
+			.practice = ((record.flags & RUNF_PRACTICE) != 0),
+		};
+		auto it = std::ranges::lower_bound(ret, key(record_key), {}, key);
+		if((it == ret.end()) || (key(*it) != key(record_key))) {
+			it = ret.insert(it, record_key);
+		}
+		auto& s = *it;
+		const auto score = stages.back().score;
+		s.runs++;
+		s.clears += (record.end == RUN_END::CLEAR);
+		s.score_best = (std::max)(s.score_best, int64_t{ score });
+		s.score_sum += score;
+		for(const auto& stage : stages) {
+			s.graze_sum += stage.graze;
+			s.bombs_sum += stage.bombs;
+			s.misses_sum += stage.misses;
+		}
+	}
+	return ret;
+}
+
+// Formats a Unix timestamp as an ISO 8601 date and time in UTC.
+static void StringCatTime(std::string& str, int64_t t)
+{
+	using namespace std::chrono;
+	const auto tp = sys_seconds{ seconds{ t } };
+	const auto day = floor<days>(tp);
+	const auto ymd = year_month_day{ day };
+	const auto hms = hh_mm_ss{ (tp - day) };
+
+	std::array<char, 32> buf;
+	const auto len = snprintf(
+		buf.data(),
+		buf.size(),
+		"%04d-%02u-%02uT%02d:%02d:%02dZ",
+		static_cast<int>(ymd.year()),
+		static_cast<unsigned int>(ymd.month()),
+		static_cast<unsigned int>(ymd.day()),
+		static_cast<int>(hms.hours().count()),
+		static_cast<int>(hms.minutes().count()),
+		static_cast<int>(hms.seconds().count())
+	);
+	if(len > 0) {
+		str.append(buf.data(), (std::min)(size_t(len), (buf.size() - 1)));
+	}
+}
+
+std::string RunHistory_CSV(std::span<const RUN_RECORD> records)
+{
+	std::string ret = (
+		"run,start,end,level,weapon,practice,result,replay,"
+		"stage,score,graze,bombs,misses,continues\n"
+	);
+	for(size_t i = 0; i < records.size(); i++) {
+		const auto& record = records[i];
+		auto prefix = (std::to_string(i + 1) + ',');
+		StringCatTime(prefix, record.time_start);
+		prefix += ',';
+		StringCatTime(prefix, record.time_end);
+		prefix += ',';
+		prefix += RUN_LEVEL_NAMES[record.level];
+		prefix += ',';
+		prefix += std::to_string(record.weapon);
+		prefix += ((record.flags & RUNF_PRACTICE) ? ",1," : ",0,");
+		prefix += RUN_END_NAMES[std::to_underlying(record.end)];
+		prefix += ',';
+		if(record.flags & RUNF_REPLAY) {
+			const auto hex = HashHex(record.replay);
+			prefix.append(hex.data(), hex.size());
+		}
+		prefix += ',';
+
+		for(const auto& stage : record.Stages()) {
+			ret += prefix;
+			ret += ((stage.stage == GRAPH_ID_EXSTAGE)
+				? "Ex"
+				: std::to_string(stage.stage)
+			);
+			ret += ',';
+			ret += std::to_string(int64_t{ stage.score });
+			ret += ',';
+			ret += std::to_string(uint32_t{ stage.graze });
+			ret += ',';
+			ret += std::to_string(stage.bombs);
+			ret += ',';
+			ret += std::to_string(stage.misses);
+			ret += ',';
+			ret += std::to_string(stage.continues);
+			ret += '\n';
+		}
+	}
+	return ret;
+}
+// --------
@@ -0,0 +1,141 @@
+/*
+ *   Run history
+ *
+ */
+
+#pragma once
+
+#include "CONFIG.H"
+#include "game/endian.h"
+#include "game/hash.h"
+
+// Unlike the high score table, which only keeps the top NR_RANK_MAX entries
+// per difficulty, every run started from the shot type selection is appended
+// to a separate file once it ends. Runs are never recorded during replays or
+// demos.
+//
+// Records have a fixed size, and are only ever appended. Since a crash can
+// leave a partial record at the end of the file, readers skip over invalid
+// data until the next record header.
+
+// Format
+// ------
+
+constexpr const std::array<char, 4> RUN_HEADNAME = { 'R', 'U', 'N', 0x1A };
+
+// How a run ended.
+enum class RUN_END : uint8_t {
+	QUIT,	// Quit from the pause menu, or by closing the game
+	CLEAR,
+	GAMEOVER,	// Game over without continuing
+};
+
+// Run flags
+constexpr uint8_t RUNF_PRACTICE = 0x01;	// Started via the stage selection
+constexpr uint8_t RUNF_REPLAY = 0x02;	// A replay was saved
+
+// Statistics of a single stage within a run.
+struct RUN_STAGE {
+	I64LE score;	// Score at the end of the stage
+	U32LE graze;	// Graze during the stage
+	uint8_t stage;	// 1-6, or GRAPH_ID_EXSTAGE
+	uint8_t bombs;	// Saturates at 255, like the counters below
+	uint8_t misses;
+	uint8_t continues;
+};
+
+struct RUN_RECORD {
+	std::array<char, RUN_HEADNAME.size()> name = RUN_HEADNAME;
+	U32LE sum;	// Byte sum of everything after this field
+	I64LE time_start;	// Seconds since the Unix epoch, in UTC
+	I64LE time_end;
+	uint8_t level;	// GAME_EASY to GAME_EXTRA
+	uint8_t weapon;
+	RUN_END end;
+	uint8_t flags;
+	uint8_t stage_count;	// Number of valid entries in [stages]
+	uint8_t unused[3];
+	std::array<RUN_STAGE, STAGE_MAX> stages;
+
+	// Hash of the input stream of the replay saved for this run, if
+	// [RUNF_REPLAY] is set. Matches the `hash` reported by
+	// `--verify-replay-file`.
+	HASH replay;
+
+	uint32_t Sum(void) const;
+	bool Valid(void) const;
+
+	std::span<const RUN_STAGE> Stages(void) const {
+		return std::span{ stages }.first(stage_count);
+	}
+};
+
+static_assert(sizeof(RUN_STAGE) == 16);
+static_assert(sizeof(RUN_RECORD) == 160);
+
+constexpr std::string_view RUN_LEVEL_NAMES[] = {
+	"Easy", "Normal", "Hard", "Lunatic", "Extra"
+};
+constexpr std::string_view RUN_END_NAMES[] = { "quit", "clear", "gameover" };
+// ------
+
+// Recording
+// ---------
+// All of these do nothing if no run is active. The counters are part of the
+// simulation state, so that run-ahead rolls back any bombs or misses it only
+// speculated about.
+
+// Starts a new run with the current difficulty and shot type, on the current
+// stage.
+void RunHistory_Start(uint8_t level);
+
+// Completes the statistics of the current stage, and starts the next one.
+void RunHistory_NextStage(void);
+
+void RunHistory_Bomb(void);
+void RunHistory_Miss(void);
+void RunHistory_Continue(void);
+
+// Sets how the run will end once RunHistory_Finish() is called. Runs end in
+// RUN_END::QUIT by default.
+void RunHistory_SetEnd(RUN_END end);
+
+// Associates the run with the given replay input stream.
+void RunHistory_SetReplay(const HASH& hash);
+
+// Completes the run and queues it for appending to the history file.
+void RunHistory_Finish(void);
+// ---------
+
+// Querying
+// --------
+
+// Returns all valid records in [buf], in order.
+std::vector<RUN_RECORD> RunHistory_Parse(BYTE_BUFFER_BORROWED buf);
+
+// Waits for any queued runs to be written, and returns all valid records from
+// the history file.
+std::vector<RUN_RECORD> RunHistory_Load(void);
+
+// Statistics of all runs with the same start stage, difficulty, and shot type.
+struct RUN_STATS {
+	uint8_t stage;	// 1 for full games, or the selected practice stage
+	uint8_t level;
+	uint8_t weapon;
+	bool practice;
+	uint32_t runs = 0;
+	uint32_t clears = 0;
+	int64_t score_best = 0;
+	int64_t score_sum = 0;
+	uint64_t graze_sum = 0;
+	uint64_t bombs_sum = 0;
+	uint64_t misses_sum = 0;
+};
+
+// Groups [records] by start stage, difficulty, and shot type, sorted by these
+// keys.
+std::vector<RUN_STATS> RunHistory_Stats(std::span<const RUN_RECORD> records);
+
+// Returns [records] as CSV, with one row per stage of each run.
+std::string RunHistory_CSV(std::span<const RUN_RECORD> records);
+// --------
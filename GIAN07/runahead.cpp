@@ -0,0 +1,50 @@
+/*
+ *   Run-ahead
+ *
+ */
+
+#include "runahead.h"
+#include "GAMEMAIN.H"
+#include "game/snapshot.h"
+#include "game/snd.h"
+
+static bool Speculating = false;
+static bool Cancelled = false;
+static BYTE_BUFFER_GROWABLE Snapshot;
+
+bool RunAhead_Speculating(void)
+{
+	return Speculating;
+}
+
+void RunAhead_Cancel(void)
+{
+	Cancelled = true;
+}
+
+void RunAhead(uint8_t frames, void (*move)(void), void (*draw)(void))
+{
+	if(frames == 0) {
+		draw();
+		return;
+	}
+
+	const auto main_prev = GameMain;
+	Snapshot_Save(Snapshot);
+
+	Speculating = true;
+	Snd_SEMuted = true;
+	for(uint8_t i = 0; i < frames; i++) {
+		move();
+		if(Cancelled || (GameMain != main_prev)) {
+			break;
+		}
+	}
+	Snd_SEMuted = false;
+	Speculating = false;
+	Cancelled = false;
+	GameMain = main_prev;
+
+	draw();
+	Snapshot_Restore(Snapshot);
+}
@@ -0,0 +1,31 @@
+/*
+ *   Run-ahead
+ *
+ */
+
+#pragma once
+
+import std.compat;
+
+// Hides [frames] frames of input latency by simulating that many frames past
+// the real one with the current input, rendering the result, and then rolling
+// back to the real frame. Sound effects are only played for real frames, and
+// therefore lag behind the picture by [frames].
+//
+// Since speculation never touches the real frame, and the real frame is
+// simulated exactly as it would have been without run-ahead, replays remain
+// identical.
+
+// Runs [move] for up to [frames] speculative frames, calls [draw], and then
+// restores the simulation state to what it was before the call.
+// Speculation stops early if a frame requests an effect that can't be rolled
+// back, or switches to a different game mode.
+void RunAhead(uint8_t frames, void (*move)(void), void (*draw)(void));
+
+// Returns whether the simulation is currently running a speculative frame.
+bool RunAhead_Speculating(void);
+
+// Must be called from any simulation code that is about to cause an effect
+// that can't be rolled back, which must then be skipped. Stops the current
+// speculation after the active frame.
+void RunAhead_Cancel(void);
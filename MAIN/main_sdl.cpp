@@ -21,10 +21,21 @@
 #include <SDL3/SDL.h>
 #include <SDL3/SDL_main.h>
 
+// GCC 15 can't #include this after a module import.
+#include <stdio.h> // For `stdout`
+
+#include "GIAN07/DEMOPLAY.H"
 #include "GIAN07/ENTRY.H"
+#include "GIAN07/GAMEMAIN.H"
+#include "GIAN07/LOADER.H"
+#include "GIAN07/MAID.H"
+#include "GIAN07/entity.h"
+#include "GIAN07/run_history.h"
 #include "platform/window_backend.h"
 #include "platform/sdl/log_sdl.h"
+#include "game/bgm.h"
 #include "game/defer.h"
+#include "game/snd.h"
 #include "strings/title.h"
 #include "obj/platform_constants.h"
 #include "obj/version.h"
@@ -32,6 +43,347 @@
 #define UTF8_(S) u8 ## S
 #define UTF8(S) UTF8_(S)
 
+// `--entity-capacity` arguments, forwarded to every replay verification
+// process since they affect the simulation.
+static std::vector<const char *> EntityCapacityArgs;
+
+static int StageFromArg(const char *stage_str)
+{
+	return (SDL_strcasecmp(stage_str, "ex")
+		? SDL_atoi(stage_str)
+		: GRAPH_ID_EXSTAGE
+	);
+}
+
+static std::string_view Basename(std::string_view fn)
+{
+	const auto basename_start = fn.find_last_of("/\\");
+	return ((basename_start != std::string_view::npos)
+		? fn.substr(basename_start + 1)
+		: fn
+	);
+}
+
+// Resolves [fn] against the current working directory. Required for all paths
+// given on the command line that are only used after XInit() has switched to
+// the data directory.
+static std::string PathAbsolute(const char *fn)
+{
+	std::error_code ec;
+	const auto* fn8 = std::bit_cast<const char8_t *>(fn);
+	const auto ret = std::filesystem::absolute(fn8, ec).u8string();
+	if(ec) {
+		return fn;
+	}
+	return { std::bit_cast<const char *>(ret.data()), ret.size() };
+}
+
+// Replays the given stage without rendering, and reports the first frame
+// whose state diverged from the hash trace recorded in the replay.
+static int VerifyReplay(const char *stage_str)
+{
+	const auto stage = StageFromArg(stage_str);
+	if(!GameReplayVerify(stage)) {
+		SDL_LogError(
+			SDL_LOG_CATEGORY_APPLICATION,
+			"Could not load the replay for stage %s.",
+			stage_str
+		);
+		return 2;
+	}
+	if(!DemoplayHasHashTrace()) {
+		SDL_LogError(
+			SDL_LOG_CATEGORY_APPLICATION,
+			"The replay for stage %s does not contain a state hash trace.",
+			stage_str
+		);
+		return 2;
+	}
+	const auto& maybe_desync = DemoplayDesync();
+	if(!maybe_desync) {
+		SDL_Log("Stage %s: In sync.", stage_str);
+		return 0;
+	}
+	const auto desc = maybe_desync.value().Describe();
+	SDL_Log(
+		"Stage %s: Desync at %s",
+		stage_str,
+		std::bit_cast<const char *>(desc.c_str())
+	);
+	return 1;
+}
+
+// Replays the given replay file without rendering, and writes a single
+// tab-separated report line to `stdout`, for collection by VerifyReplayDir().
+// The line only depends on the replay and the simulation, never on timing or
+// the directory the file is in.
+static int VerifyReplayFile(const char *fn)
+{
+	auto line = std::string{ Basename(fn) };
+	const auto ret = [&] {
+		const auto* fn8 = std::bit_cast<const char8_t *>(fn);
+		const auto maybe_stage = DemoplayStageFromFN(fn8);
+		if(!maybe_stage || !GameReplayVerify(maybe_stage.value(), fn8)) {
+			line += "\terror=load";
+			for(const auto& anomaly : DemoplaySummary().anomalies) {
+				line += "; ";
+				line += std::bit_cast<const char *>(anomaly.c_str());
+			}
+			return 2;
+		}
+		const auto stage = maybe_stage.value();
+		const auto& summary = DemoplaySummary();
+		line += "\tstage=";
+		line += ((stage == GRAPH_ID_EXSTAGE) ? "Ex" : std::to_string(stage));
+		constexpr const char *END_NAMES[] = { "quit", "clear", "gameover" };
+		line += "\tend=";
+		line += END_NAMES[std::to_underlying(summary.end)];
+		line += "\tframe=";
+		line += std::to_string(summary.end_frame);
+		line += "\tscore=";
+		line += std::to_string(Viv.score);
+		line += "\thash=";
+		if(summary.input_hash) {
+			const auto hex = HashHex(summary.input_hash.value());
+			line.append(hex.data(), hex.size());
+		} else {
+			line += "none";
+		}
+
+		line += "\tsync=";
+		const auto& maybe_desync = DemoplayDesync();
+		if(!DemoplayHasHashTrace()) {
+			line += "none";
+		} else if(!maybe_desync) {
+			line += "ok";
+		} else {
+			const auto desc = maybe_desync.value().Describe();
+			line += std::bit_cast<const char *>(desc.c_str());
+		}
+
+		line += "\tanomalies=";
+		if(summary.anomalies.empty()) {
+			line += "none";
+		}
+		for(size_t i = 0; i < summary.anomalies.size(); i++) {
+			line += ((i == 0) ? "" : "; ");
+			line += std::bit_cast<const char *>(summary.anomalies[i].c_str());
+		}
+		return ((maybe_desync || !summary.anomalies.empty()) ? 1 : 0);
+	}();
+	line += '\n';
+	fputs(line.c_str(), stdout);
+	fflush(stdout);
+	return ret;
+}
+
+// Verifies every replay file in [dir] in a separate process each, with up to
+// [jobs] processes running in parallel. The simulation has too much global
+// state to run several replays within the same process. Reports are printed
+// to `stdout` in file name order, regardless of which process finishes first.
+static int VerifyReplayDir(const char *self, const char *dir, int jobs)
+{
+	struct REPLAY {
+		std::string fn;
+		std::string basename;
+	};
+	std::vector<REPLAY> replays;
+	const auto dir_abs = PathAbsolute(dir);
+	const auto enumerated = SDL_EnumerateDirectory(
+		dir_abs.c_str(),
+		[](void *replays_p, const char *dirname, const char *basename) {
+			auto& replays = *std::bit_cast<std::vector<REPLAY> *>(replays_p);
+			const auto* basename8 = std::bit_cast<const char8_t *>(basename);
+			if(DemoplayStageFromFN(basename8)) {
+				replays.emplace_back(
+					(std::string{ dirname } + basename), basename
+				);
+			}
+			return SDL_ENUM_CONTINUE;
+		},
+		&replays
+	);
+	if(!enumerated) {
+		Log_Fail(SDL_LOG_CATEGORY_APPLICATION, "Error reading the directory");
+		return 2;
+	}
+	std::ranges::sort(replays, {}, &REPLAY::basename);
+
+	const auto spawn = [&](const REPLAY& replay) -> SDL_Process * {
+		auto args = std::vector<const char *>{ self };
+		args.insert(
+			args.end(), EntityCapacityArgs.begin(), EntityCapacityArgs.end()
+		);
+		args.insert(args.end(), {
+			"--verify-replay-file", replay.fn.c_str(), nullptr
+		});
+		const auto props = SDL_CreateProperties();
+		defer(SDL_DestroyProperties(props));
+		SDL_SetPointerProperty(
+			props, SDL_PROP_PROCESS_CREATE_ARGS_POINTER, args.data()
+		);
+		SDL_SetNumberProperty(
+			props,
+			SDL_PROP_PROCESS_CREATE_STDOUT_NUMBER,
+			SDL_PROCESS_STDIO_APP
+		);
+		SDL_SetNumberProperty(
+			props,
+			SDL_PROP_PROCESS_CREATE_STDERR_NUMBER,
+			SDL_PROCESS_STDIO_NULL
+		);
+		return SDL_CreateProcessWithProperties(props);
+	};
+
+	// Processes are collected in the order they were started. Since each
+	// one only writes a single line, none of them can block on a full pipe
+	// while we wait for an earlier one.
+	const auto t_start = SDL_GetTicks();
+	std::deque<SDL_Process *> running;
+	size_t next = 0;
+	int ret = 0;
+	for(const auto& replay : replays) {
+		while((next < replays.size()) && (running.size() < size_t(jobs))) {
+			running.emplace_back(spawn(replays[next++]));
+		}
+		auto* process = running.front();
+		running.pop_front();
+
+		int exitcode = -1;
+		size_t size = 0;
+		auto* output = (process
+			? static_cast<char *>(SDL_ReadProcess(process, &size, &exitcode))
+			: nullptr
+		);
+		defer(SDL_free(output));
+		if(process) {
+			SDL_DestroyProcess(process);
+		}
+		if(output && (size > 0) && (exitcode >= 0)) {
+			fwrite(output, 1, size, stdout);
+		} else {
+			printf(
+				"%s\terror=process exit code %d\n",
+				replay.basename.c_str(),
+				exitcode
+			);
+			exitcode = 2;
+		}
+		fflush(stdout);
+		ret = (std::max)(ret, exitcode);
+	}
+	SDL_Log(
+		"%zu replays verified in %" SDL_PRIu64 " ms.",
+		replays.size(),
+		(SDL_GetTicks() - t_start)
+	);
+	return ret;
+}
+
+// Renders the replay of the given stage to a YUV4MPEG2 video and an optional
+// .WAV file.
+static int ExportReplay(
+	const char *stage_str, const char *video_fn, const char *audio_fn
+)
+{
+	const auto stage = StageFromArg(stage_str);
+	const auto t_start = SDL_GetTicks();
+	const auto ret = GameReplayExport(
+		stage,
+		std::bit_cast<const char8_t *>(video_fn),
+		std::bit_cast<const char8_t *>(audio_fn)
+	);
+	if(ret == REPLAY_EXPORT::MIDI) {
+		SDL_LogError(
+			SDL_LOG_CATEGORY_APPLICATION,
+			"Could not export the replay for stage %s: MIDI BGM is played by "
+			"an external synthesizer and can't be rendered to a .WAV file. "
+			"Select a BGM pack with waveform tracks, disable BGM, or omit the "
+			"audio file.",
+			stage_str
+		);
+		return 1;
+	} else if(ret != REPLAY_EXPORT::OK) {
+		SDL_LogError(
+			SDL_LOG_CATEGORY_APPLICATION,
+			"Could not export the replay for stage %s.",
+			stage_str
+		);
+		return 1;
+	}
+	SDL_Log(
+		"Stage %s: Exported in %" SDL_PRIu64 " ms.",
+		stage_str,
+		(SDL_GetTicks() - t_start)
+	);
+	return 0;
+}
+
+// Prints statistics of all runs in the run history, grouped by start stage,
+// difficulty, and shot type.
+static int PrintRunHistory(void)
+{
+	const auto records = RunHistory_Load();
+	for(const auto& s : RunHistory_Stats(records)) {
+		auto mode = std::string{ RUN_LEVEL_NAMES[s.level] };
+		if(s.practice && (s.stage != GRAPH_ID_EXSTAGE)) {
+			mode += (" stage " + std::to_string(s.stage));
+		}
+		mode += (s.practice ? " practice" : "");
+		SDL_Log(
+			"%s, shot %u: %u runs, %u clears, best %" SDL_PRIs64
+			", average %" SDL_PRIs64 " (%.1f graze, %.2f bombs, %.2f misses)",
+			mode.c_str(),
+			s.weapon,
+			s.runs,
+			s.clears,
+			s.score_best,
+			(s.score_sum / s.runs),
+			(static_cast<double>(s.graze_sum) / s.runs),
+			(static_cast<double>(s.bombs_sum) / s.runs),
+			(static_cast<double>(s.misses_sum) / s.runs)
+		);
+	}
+	SDL_Log("%zu runs", records.size());
+	return 0;
+}
+
+// Writes the run history to `stdout` as CSV, with one row per stage of each
+// run.
+static int ExportRunHistory(void)
+{
+	const auto csv = RunHistory_CSV(RunHistory_Load());
+	fwrite(csv.data(), 1, csv.size(), stdout);
+	return (fflush(stdout) ? 1 : 0);
+}
+
+// Prints the BGM pack index, including the details of every track.
+static int DumpBGMIndex(void)
+{
+	BGM_PackForeach([](const std::u8string_view pack) {
+		const auto tracks = BGM_PackTracks(pack);
+		SDL_Log(
+			"%.*s: %zu tracks",
+			static_cast<int>(pack.size()),
+			std::bit_cast<const char *>(pack.data()),
+			tracks.size()
+		);
+		for(const auto& t : tracks) {
+			SDL_Log(
+				"\t%02u%.*s %u Hz, loop %" SDL_PRIu64 "-%" SDL_PRIu64,
+				(t.id + 1),
+				static_cast<int>(t.codec.size()),
+				std::bit_cast<const char *>(t.codec.data()),
+				t.samplingrate,
+				t.loop_start,
+				t.loop_end
+			);
+		}
+	});
+	SDL_Log("%zu packs", BGM_PackCount());
+	return 0;
+}
+
 int main(int argc, char** args)
 {
 	Log_Init(UTF8(GAME_TITLE));
@@ -43,6 +395,24 @@ int main(int argc, char** args)
 	// metadata, avoiding the need for the environment variable below.
 	SDL_SetAppMetadata(GAME_TITLE, VERSION_TAG, APP_ID);
 
+	// Replay verification only runs the simulation, and export renders into
+	// memory. Neither must open any window or audio device, so that both also
+	// work on headless machines.
+	const auto headless = std::ranges::any_of(
+		std::span(args, argc), [](const char *arg) {
+			return (
+				(SDL_strcmp(arg, "--verify-replay") == 0) ||
+				(SDL_strcmp(arg, "--verify-replay-file") == 0) ||
+				(SDL_strcmp(arg, "--export-replay") == 0)
+			);
+		}
+	);
+	if(headless) {
+		SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "dummy");
+		SDL_SetHint(SDL_HINT_AUDIO_DRIVER, "dummy");
+		Snd_Offline = true;
+	}
+
 	if(!SDL_Init(SDL_INIT_JOYSTICK | SDL_INIT_VIDEO)) {
 		Log_Fail(SDL_LOG_CATEGORY_VIDEO, "Error initializing SDL");
 		return 1;
@@ -57,6 +427,48 @@ int main(int argc, char** args)
 	// activate it after SDL_Init().
 	SDL_SetLogPriorities(SDL_LOG_PRIORITY_VERBOSE);
 
+	// Entity capacities must be known before XInit() allocates them.
+	while((argc >= 3) && (SDL_strcmp(args[1], "--entity-capacity") == 0)) {
+		const auto* spec = std::bit_cast<const char8_t *>(args[2]);
+		if(!Entity_SetCapacity(spec)) {
+			SDL_LogCritical(
+				SDL_LOG_CATEGORY_APPLICATION,
+				"Invalid entity capacity: %s (expected <pool>=<count>)",
+				args[2]
+			);
+			return 1;
+		}
+		EntityCapacityArgs.insert(EntityCapacityArgs.end(), {
+			args[1], args[2]
+		});
+		args[2] = args[0]; // Keep the program name
+		args += 2;
+		argc -= 2;
+	}
+
+	// Only need the data directory.
+	if((argc == 2) && (SDL_strcmp(args[1], "--dump-bgm-index") == 0)) {
+		return (XDataPathSet() ? DumpBGMIndex() : 1);
+	}
+	if((argc == 2) && (SDL_strcmp(args[1], "--run-history") == 0)) {
+		return (XDataPathSet() ? PrintRunHistory() : 1);
+	}
+	if((argc == 2) && (SDL_strcmp(args[1], "--export-run-history") == 0)) {
+		return (XDataPathSet() ? ExportRunHistory() : 1);
+	}
+
+	// Spawns one process per replay, each doing their own initialization.
+	if(
+		((argc == 3) || (argc == 4)) &&
+		(SDL_strcmp(args[1], "--verify-replay-dir") == 0)
+	) {
+		const auto jobs = ((argc == 4)
+			? SDL_atoi(args[3])
+			: SDL_GetNumLogicalCPUCores()
+		);
+		return VerifyReplayDir(args[0], args[2], (std::max)(jobs, 1));
+	}
+
 	// Use the backend API's line drawing algorithm, which at least gives us
 	// pixel-perfect accuracy with pbg's original 16-bit code when using
 	// Direct3D and framebuffer scaling. It does make sense to set this hint
@@ -74,6 +486,38 @@ int main(int argc, char** args)
 	// 	https://github.com/nmlgc/ssg/issues/74
 	SDL_SetHint(SDL_HINT_RENDER_LINE_METHOD, "2");
 
+	// Modes that need the full game. Any paths must be resolved before
+	// XInit() switches the working directory.
+	std::function<int(void)> mode;
+	if((argc == 3) && (SDL_strcmp(args[1], "--verify-replay") == 0)) {
+		XHeadless = true;
+		mode = [stage_str = args[2]] {
+			return VerifyReplay(stage_str);
+		};
+	} else if(
+		(argc == 3) && (SDL_strcmp(args[1], "--verify-replay-file") == 0)
+	) {
+		XHeadless = true;
+		mode = [fn = PathAbsolute(args[2])] {
+			return VerifyReplayFile(fn.c_str());
+		};
+	} else if(
+		((argc == 4) || (argc == 5)) &&
+		(SDL_strcmp(args[1], "--export-replay") == 0)
+	) {
+		mode = [
+			stage_str = args[2],
+			video_fn = PathAbsolute(args[3]),
+			audio_fn = ((argc == 5) ? PathAbsolute(args[4]) : std::string{})
+		] {
+			return ExportReplay(
+				stage_str,
+				video_fn.c_str(),
+				(audio_fn.empty() ? nullptr : audio_fn.c_str())
+			);
+		};
+	}
+
 	if(!XInit()) {
 		// This is not a SDL error.
 		constexpr auto str = (
@@ -86,6 +530,5 @@ int main(int argc, char** args)
 		return 1;
 	}
 	defer(XCleanup());
-
-	return WndBackend_Run();
+	return (mode ? mode() : WndBackend_Run());
 }
@@ -25,7 +25,6 @@ local platform_cfg = ssg_cfg:branch(PLATFORM_LINK)
 local platform_src = SSG.glob("platform/sdl/*.cpp")
 platform_src += SSG.glob("platform/miniaudio/*.cpp")
 platform_src += SSG.glob("platform/pangocairo/*.cpp")
-platform_src += "MAIN/main_sdl.cpp"
 platform_src.extra_inputs += PLATFORM_CONSTANTS
 ssg_obj = (
 	ssg_obj +
@@ -36,4 +35,9 @@ ssg_obj = (
 	CONFIG:branch(SSG_COMPILE):cc(SSG.glob("platform/miniaudio/*.c"))
 )
 
-platform_cfg:exe(ssg_obj, "GIAN07")
+local main_src = {}
+main_src += "MAIN/main_sdl.cpp"
+main_src.extra_inputs += PLATFORM_CONSTANTS
+
+platform_cfg:exe((ssg_obj + platform_cfg:cxx(main_src)), "GIAN07")
+platform_cfg:exe((ssg_obj + platform_cfg:cxx(TEST_SRC)), "GIAN07_test")
@@ -20,4 +20,7 @@ SSG_SRC.extra_inputs += PLATFORM_CONSTANTS
 LAYERS_SRC += SSG.glob("game/*.cpp")
 LAYERS_SRC += SSG.glob("game/codecs/*.cpp")
 
+-- Tests, linked against everything except the game's entry point
+TEST_SRC += SSG.glob("test/*.cpp")
+
 tup.include(string.format("Tupfile.%s.lua", tup.getconfig("TUP_PLATFORM")))
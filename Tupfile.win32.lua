@@ -117,7 +117,6 @@ local function ssg(variant)
 	if (variant == MODERN) then
 		p_modern_src += "platform/sdl/graphics_sdl.cpp"
 	end
-	p_modern_src += "MAIN/main_sdl.cpp"
 	p_modern_src.extra_inputs += PLATFORM_CONSTANTS
 	ssg_obj = (ssg_obj + ssg_cfg:cxx(p_modern_src))
 
@@ -131,8 +130,21 @@ local function ssg(variant)
 		ssg_cfg = ssg_cfg:branch(COMPAT_LINK)
 	end
 
-	ssg_obj = (ssg_obj + ssg_ico)
-	ssg_cfg:exe(ssg_obj, ("GIAN07" .. variant_bin_suffix))
+	local main_src = {}
+	main_src += "MAIN/main_sdl.cpp"
+	main_src.extra_inputs += PLATFORM_CONSTANTS
+	local main_obj = (ssg_cfg:cxx(main_src) + ssg_ico)
+	ssg_cfg:exe((ssg_obj + main_obj), ("GIAN07" .. variant_bin_suffix))
+
+	-- Tests only need to run on the development system.
+	if (variant == MODERN) then
+		local test_cfg = ssg_cfg:branch({
+			lflags = flag_remove("/SUBSYSTEM:.*"),
+		}, {
+			lflags = "/SUBSYSTEM:console",
+		})
+		test_cfg:exe((ssg_obj + test_cfg:cxx(TEST_SRC)), "GIAN07_test")
+	end
 end
 
 ssg(MODERN)
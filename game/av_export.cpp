@@ -0,0 +1,366 @@
+/*
+ *   Offline audio/video export
+ *
+ */
+
+#include <SDL3/SDL_iostream.h>
+
+#include "game/av_export.h"
+#include "game/endian.h"
+#include "game/snd.h"
+#include "game/string_format.h"
+#include "platform/file.h"
+#include "platform/graphics_backend.h"
+#include "platform/thread.h"
+
+// Number of captured frames that can wait for conversion at the same time.
+constexpr size_t FRAMES_IN_FLIGHT = 4;
+
+constexpr size_t RES_W = GRP_RES.w;
+constexpr size_t RES_H = GRP_RES.h;
+constexpr size_t LUMA_SIZE = (RES_W * RES_H);
+constexpr size_t CHROMA_SIZE = ((RES_W / 2) * (RES_H / 2));
+constexpr size_t YUV_SIZE = (LUMA_SIZE + (2 * CHROMA_SIZE));
+constexpr size_t CAPTURE_PITCH = (RES_W * sizeof(uint32_t));
+
+static_assert(((RES_W % 2) == 0) && ((RES_H % 2) == 0));
+
+// .WAV header
+// -----------
+
+#pragma pack(push, 1)
+struct WAV_HEADER {
+	std::array<char, 4> riff_id = { 'R', 'I', 'F', 'F' };
+	U32LE riff_size;
+	std::array<char, 4> wave_id = { 'W', 'A', 'V', 'E' };
+	std::array<char, 4> fmt_id = { 'f', 'm', 't', ' ' };
+	U32LE fmt_size = 16;
+	U16LE format = 1; // WAVE_FORMAT_PCM
+	U16LE channels;
+	U32LE rate;
+	U32LE bytes_per_sec;
+	U16LE block_align;
+	U16LE bits_per_sample = 16;
+	std::array<char, 4> data_id = { 'd', 'a', 't', 'a' };
+	U32LE data_size;
+
+	WAV_HEADER(const SND_OFFLINE_FORMAT& fmt, uint32_t data_size) :
+		riff_size((sizeof(WAV_HEADER) - 8) + data_size),
+		channels(fmt.channels),
+		rate(fmt.rate),
+		bytes_per_sec(fmt.rate * fmt.channels * sizeof(int16_t)),
+		block_align(fmt.channels * sizeof(int16_t)),
+		data_size(data_size) {
+	}
+};
+#pragma pack(pop)
+// -----------
+
+static struct {
+	SDL_IOStream *video = nullptr;
+	SDL_IOStream *audio = nullptr;
+	PIXELFORMAT format;
+
+	// Capture ring. Slot (`submitted` % FRAMES_IN_FLIGHT) is owned by the game
+	// thread, and slots in the range [`written`, `submitted`[ are owned by the
+	// conversion thread.
+	std::array<BYTE_BUFFER_OWNED, FRAMES_IN_FLIGHT> slots;
+	BYTE_BUFFER_OWNED yuv;
+	uint64_t submitted = 0;
+	uint64_t written = 0;
+	bool closing = false;
+	bool failed = false;
+	std::mutex mutex;
+	std::condition_variable cv;
+	THREAD thread;
+
+	std::optional<SND_OFFLINE_FORMAT> snd;
+	uint64_t snd_frames = 0;
+	std::vector<float> mix;
+	std::vector<I16LE> pcm;
+} Export;
+
+// Video conversion
+// ----------------
+
+// BT.601 limited range, in 8.8 fixed point.
+static uint8_t Luma(int r, int g, int b)
+{
+	const auto v = ((66 * r) + (129 * g) + (25 * b) + 128);
+	return static_cast<uint8_t>((v >> 8) + 16);
+}
+
+static uint8_t ChromaU(int r, int g, int b)
+{
+	const auto v = ((-38 * r) - (74 * g) + (112 * b) + 128);
+	return static_cast<uint8_t>((v >> 8) + 128);
+}
+
+static uint8_t ChromaV(int r, int g, int b)
+{
+	const auto v = ((112 * r) - (94 * g) - (18 * b) + 128);
+	return static_cast<uint8_t>((v >> 8) + 128);
+}
+
+// Converts a tightly packed 32-bit frame to planar 4:2:0.
+static void ConvertI420(
+	std::byte *yuv, const std::byte *src, PIXELFORMAT format
+)
+{
+	// All supported 32-bit formats store the three channels in the first three
+	// bytes, in either RGB or BGR order.
+	const auto ri = ((format.format == PIXELFORMAT::RGBA8888) ? 0 : 2);
+	const auto bi = (2 - ri);
+
+	auto* y_plane = reinterpret_cast<uint8_t *>(yuv);
+	auto* u_plane = (y_plane + LUMA_SIZE);
+	auto* v_plane = (u_plane + CHROMA_SIZE);
+	const auto* p = reinterpret_cast<const uint8_t *>(src);
+	for(size_t y = 0; y < RES_H; y += 2) {
+		const auto* row0 = (p + (y * CAPTURE_PITCH));
+		const auto* row1 = (row0 + CAPTURE_PITCH);
+		auto* y_row0 = (y_plane + (y * RES_W));
+		auto* y_row1 = (y_row0 + RES_W);
+		for(size_t x = 0; x < RES_W; x += 2) {
+			int r_sum = 0;
+			int g_sum = 0;
+			int b_sum = 0;
+			const auto pixel = [&](const uint8_t *px, uint8_t *y_out) {
+				const int r = px[ri];
+				const int g = px[1];
+				const int b = px[bi];
+				*y_out = Luma(r, g, b);
+				r_sum += r;
+				g_sum += g;
+				b_sum += b;
+			};
+			pixel(&row0[(x + 0) * 4], &y_row0[x + 0]);
+			pixel(&row0[(x + 1) * 4], &y_row0[x + 1]);
+			pixel(&row1[(x + 0) * 4], &y_row1[x + 0]);
+			pixel(&row1[(x + 1) * 4], &y_row1[x + 1]);
+			const auto r = ((r_sum + 2) / 4);
+			const auto g = ((g_sum + 2) / 4);
+			const auto b = ((b_sum + 2) / 4);
+			*(u_plane++) = ChromaU(r, g, b);
+			*(v_plane++) = ChromaV(r, g, b);
+		}
+	}
+}
+
+static bool WriteFrame(const BYTE_BUFFER_OWNED& capture)
+{
+	static constexpr std::string_view FRAME_HEADER = "FRAME\n";
+
+	ConvertI420(
+		reinterpret_cast<std::byte *>(Export.yuv.get()),
+		reinterpret_cast<const std::byte *>(capture.get()),
+		Export.format
+	);
+	return (
+		SDL_MustWriteIO(Export.video, FRAME_HEADER.data(), FRAME_HEADER.size())
+		&& SDL_MustWriteIO(Export.video, Export.yuv.get(), YUV_SIZE)
+	);
+}
+
+static void ConvertThread(const THREAD_STOP&)
+{
+	while(true) {
+		std::unique_lock lock{ Export.mutex };
+		Export.cv.wait(lock, [] {
+			return (Export.closing || (Export.written < Export.submitted));
+		});
+		if(Export.written == Export.submitted) {
+			return;
+		}
+		const auto& slot = Export.slots[Export.written % FRAMES_IN_FLIGHT];
+		lock.unlock();
+
+		const auto ok = WriteFrame(slot);
+
+		lock.lock();
+		Export.failed |= !ok;
+		Export.written++;
+		Export.cv.notify_all();
+	}
+}
+// ----------------
+
+// Audio
+// -----
+
+static bool WriteWAVHeader(void)
+{
+	const auto data_size = (
+		Export.snd_frames * Export.snd.value().channels * sizeof(int16_t)
+	);
+	// Clamp to the largest size that still fits the RIFF size field.
+	constexpr uint64_t DATA_SIZE_MAX = (
+		(std::numeric_limits<uint32_t>::max)() - sizeof(WAV_HEADER)
+	);
+	const WAV_HEADER header = {
+		Export.snd.value(),
+		static_cast<uint32_t>((std::min)(data_size, DATA_SIZE_MAX)),
+	};
+	return (
+		(SDL_SeekIO(Export.audio, 0, SDL_IO_SEEK_SET) == 0) &&
+		SDL_MustWriteIO(Export.audio, &header, sizeof(header))
+	);
+}
+
+static bool WriteAudio(void)
+{
+	if(!Export.snd) {
+		return true;
+	}
+	const auto& snd = Export.snd.value();
+
+	// The game runs at a fixed frame time rather than a fixed frame rate, so
+	// we calculate the sample count from the total elapsed time to avoid
+	// drift.
+	const auto frame_end = (Export.submitted * FRAME_TIME_TARGET * snd.rate);
+	const auto frames = ((frame_end / 1000) - Export.snd_frames);
+	Export.mix.resize(frames * snd.channels);
+	Export.pcm.resize(frames * snd.channels);
+	Snd_OfflineRender(Export.mix);
+	std::ranges::transform(Export.mix, Export.pcm.begin(), [](float v) {
+		return static_cast<int16_t>(std::clamp(v, -1.0f, 1.0f) * 32767.0f);
+	});
+	Export.snd_frames += frames;
+	if(!Export.audio) {
+		return true;
+	}
+	return SDL_MustWriteIO(
+		Export.audio, Export.pcm.data(), (Export.pcm.size() * sizeof(I16LE))
+	);
+}
+// -----
+
+bool AVExport_Open(const char8_t *video_fn, const char8_t *audio_fn)
+{
+	Export.format = GrpBackend_PixelFormat();
+	if(Export.format.PixelSize() != PIXELFORMAT::SIZE32) {
+		return false;
+	}
+
+	Export.video = SDL_IOFromFile(video_fn, "wb");
+	if(!Export.video) {
+		return false;
+	}
+
+	// The frame rate of a game running at a fixed frame time of
+	// [FRAME_TIME_TARGET] milliseconds.
+	std::u8string header = u8"YUV4MPEG2 W";
+	StringCatNum<0>(GRP_RES.w, header);
+	header += u8" H";
+	StringCatNum<0>(GRP_RES.h, header);
+	header += u8" F1000:";
+	StringCatNum<0>(FRAME_TIME_TARGET, header);
+	header += u8" Ip A1:1 C420jpeg XCOLORRANGE=LIMITED\n";
+	if(!SDL_MustWriteIO(Export.video, header.data(), header.size())) {
+		AVExport_Close();
+		return false;
+	}
+
+	if(audio_fn) {
+		Export.audio = SDL_IOFromFile(audio_fn, "wb");
+		if(!Export.audio) {
+			AVExport_Close();
+			return false;
+		}
+	}
+	Export.snd = Snd_OfflineStart();
+	if(Export.audio && (!Export.snd || !WriteWAVHeader())) {
+		AVExport_Close();
+		return false;
+	}
+
+	for(auto& slot : Export.slots) {
+		slot = BYTE_BUFFER_OWNED{ CAPTURE_PITCH * RES_H };
+	}
+	Export.yuv = BYTE_BUFFER_OWNED{ YUV_SIZE };
+	if(!Export.yuv || std::ranges::any_of(Export.slots, [](const auto& s) {
+		return !s;
+	})) {
+		AVExport_Close();
+		return false;
+	}
+	Export.submitted = 0;
+	Export.written = 0;
+	Export.snd_frames = 0;
+	Export.closing = false;
+	Export.failed = false;
+
+	// Without a thread, AVExport_Frame() converts every frame itself.
+	Export.thread = ThreadStart(ConvertThread);
+	return true;
+}
+
+bool AVExport_Frame(void)
+{
+	const auto threaded = Export.thread.Joinable();
+	{
+		std::unique_lock lock{ Export.mutex };
+		Export.cv.wait(lock, [] {
+			return ((Export.submitted - Export.written) < FRAMES_IN_FLIGHT);
+		});
+		if(Export.failed) {
+			return false;
+		}
+	}
+
+	auto& slot = Export.slots[Export.submitted % FRAMES_IN_FLIGHT];
+	const auto [pixels, pitch] = GrpBackend_PixelAccessLock();
+	if(pitch == 0) {
+		return false;
+	}
+	for(size_t y = 0; y < RES_H; y++) {
+		memcpy(
+			(slot.get() + (y * CAPTURE_PITCH)),
+			(pixels + (y * pitch)),
+			CAPTURE_PITCH
+		);
+	}
+	GrpBackend_PixelAccessUnlock();
+
+	{
+		std::lock_guard lock{ Export.mutex };
+		Export.submitted++;
+	}
+	if(threaded) {
+		Export.cv.notify_all();
+	} else {
+		Export.failed |= !WriteFrame(slot);
+		Export.written++;
+	}
+	return (WriteAudio() && !Export.failed);
+}
+
+bool AVExport_Close(void)
+{
+	{
+		std::lock_guard lock{ Export.mutex };
+		Export.closing = true;
+	}
+	Export.cv.notify_all();
+	Export.thread.Join();
+
+	auto ret = !Export.failed;
+	if(Export.audio) {
+		ret &= WriteWAVHeader();
+		ret &= SDL_CloseIO(Export.audio);
+		Export.audio = nullptr;
+	}
+	if(Export.video) {
+		ret &= SDL_CloseIO(Export.video);
+		Export.video = nullptr;
+	}
+	if(Export.snd) {
+		Snd_OfflineEnd();
+		Export.snd = std::nullopt;
+	}
+	for(auto& slot : Export.slots) {
+		slot = nullptr;
+	}
+	Export.yuv = nullptr;
+	return ret;
+}
@@ -0,0 +1,35 @@
+/*
+ *   Offline audio/video export
+ *
+ */
+
+#pragma once
+
+import std.compat;
+
+// Captures the game's output frame by frame, independent of real time and as
+// fast as the game can be rendered.
+//
+// • Video is written as an uncompressed YUV4MPEG2 stream with 4:2:0 chroma
+//   subsampling in BT.601 limited range, at the game's native resolution and
+//   frame rate. Since this format doesn't require seeking, [video_fn] can also
+//   be a named pipe that is read by an external encoder.
+// • Audio is written as 16-bit PCM .WAV, and covers everything that goes
+//   through Snd_OfflineRender().
+//
+// Frames are converted and written on a separate thread, with several frames
+// in flight, so that the game can already render the next frame while the
+// previous ones are still being written.
+
+// Opens the output files and detaches the sound system from the audio device.
+// [audio_fn] can be a `nullptr` to only export video. The graphics backend
+// must already be in pixel access mode, using a 32-bit pixel format.
+bool AVExport_Open(const char8_t *video_fn, const char8_t *audio_fn);
+
+// Captures the current backbuffer together with one frame's worth of audio.
+// Returns `false` if writing any previous frame failed.
+bool AVExport_Frame(void);
+
+// Writes all frames in flight, closes the output files, and reattaches the
+// sound system to the audio device. Returns `false` if any write failed.
+bool AVExport_Close(void);
@@ -16,12 +16,17 @@
 #include "platform/midi_backend.h"
 #include "platform/path.h"
 #include "platform/snd_backend.h"
+#include "platform/thread.h"
 
 using namespace std::chrono_literals;
 
 static constexpr std::u8string_view BGM_ROOT = u8"bgm/";
 static constexpr std::u8string_view EXT_MID = u8".mid";
 
+// Amount of audio decoded ahead of time by BGM_Prefetch(). Covers the first
+// few audio callbacks after a switch, while the codec warms up its caches.
+static constexpr auto PREFETCH_DURATION = 250ms;
+
 // State
 // -----
 
@@ -36,7 +41,32 @@ static std::chrono::milliseconds MIDITableUpdatePrev;
 
 static std::optional<bool> PacksAvailable = std::nullopt;
 static std::u8string PackPath;
+
+struct PACK_INDEX_ENTRY {
+	std::u8string name;
+	std::optional<std::vector<BGM_TRACK_INFO>> tracks; // Filled on demand.
+};
+static std::vector<PACK_INDEX_ENTRY> PackIndex; // Sorted by name.
+static bool PackIndexStale = true;
 static std::shared_ptr<BGM::TRACK> Waveform; // nullptr = playing MIDI
+
+// [track] and [mid] are only accessed by the prefetch thread until it sets
+// [done].
+static struct {
+	std::u8string base_fn; // Empty if nothing is being prefetched.
+	std::u8string queued; // Started by BGM_Update() once [thread] is done.
+	std::unique_ptr<BGM::TRACK> track;
+	BYTE_BUFFER_OWNED mid; // The pack's MIDI for the same track, if any.
+	std::atomic<bool> done = false;
+	THREAD thread;
+} Prefetch;
+
+// Switch that waits for the prefetch thread to finish opening its track.
+struct PENDING_SWITCH {
+	unsigned int id;
+	std::chrono::milliseconds crossfade;
+};
+static std::optional<PENDING_SWITCH> Pending;
 // -----
 
 // External dependencies
@@ -66,8 +96,91 @@ bool BGM_Init(void)
 	return Enabled;
 }
 
+static bool PrefetchRunning(void)
+{
+	return (
+		Prefetch.thread.Joinable() &&
+		!Prefetch.done.load(std::memory_order_acquire)
+	);
+}
+
+// Blocks if the prefetch thread is still running.
+static void PrefetchClear(void)
+{
+	Prefetch.thread.Join();
+	Prefetch.base_fn.clear();
+	Prefetch.track = nullptr;
+	Prefetch.mid = nullptr;
+}
+
+// Starts prefetching [base_fn] if the prefetch thread is idle, or queues it
+// to be started by BGM_Update() otherwise. Never blocks, since the codecs
+// can't be interrupted while opening a file.
+static void PrefetchRequest(std::u8string&& base_fn)
+{
+	if(Prefetch.base_fn == base_fn) {
+		Prefetch.queued.clear();
+		return;
+	}
+	if(PrefetchRunning()) {
+		Prefetch.queued = std::move(base_fn);
+		return;
+	}
+	PrefetchClear();
+	Prefetch.base_fn = std::move(base_fn);
+	Prefetch.done.store(false, std::memory_order_relaxed);
+	Prefetch.thread = ThreadStart([](const THREAD_STOP&) {
+		auto track = BGM::TrackOpen(Prefetch.base_fn);
+		if(track) {
+			track->Prefetch(PREFETCH_DURATION);
+		}
+		if(!track || !track->metadata.source_midi) {
+			auto fn = Prefetch.base_fn;
+			fn += EXT_MID;
+			Prefetch.mid = SDL_LoadFile(fn.c_str());
+		}
+		Prefetch.track = std::move(track);
+		Prefetch.done.store(true, std::memory_order_release);
+	});
+
+	// Not worth doing synchronously.
+	if(!Prefetch.thread.Joinable()) {
+		Prefetch.base_fn.clear();
+	}
+}
+
+struct PREFETCHED {
+	std::unique_ptr<BGM::TRACK> track;
+	BYTE_BUFFER_OWNED mid;
+};
+
+// Returns the prefetched files for [base_fn], or `std::nullopt` if that track
+// hasn't been prefetched.
+static std::optional<PREFETCHED> PrefetchTake(std::u8string_view base_fn)
+{
+	if((Prefetch.base_fn != base_fn) || PrefetchRunning()) {
+		return std::nullopt;
+	}
+	PREFETCHED ret = {
+		.track = std::move(Prefetch.track), .mid = std::move(Prefetch.mid),
+	};
+	PrefetchClear();
+	return ret;
+}
+
+// Returns the pack file name of the given track, without extension.
+static std::u8string PackTrackFN(unsigned int id)
+{
+	std::u8string ret = PackPath;
+	StringCatNum<2>((id + 1), ret);
+	return ret;
+}
+
 void BGM_Cleanup(void)
 {
+	Pending = std::nullopt;
+	Prefetch.queued.clear();
+	PrefetchClear();
 	BGM_Stop();
 	MidBackend_Cleanup();
 	Snd_BGMCleanup();
@@ -167,7 +280,7 @@ bool BGM_ChangeMIDIDevice(int8_t direction)
 	return ret;
 }
 
-static bool BGM_Load(unsigned int id)
+static bool BGM_Load(unsigned int id, std::chrono::milliseconds crossfade)
 {
 	if(!PackPath.empty()) {
 		LoadedOriginalMIDI = false;
@@ -177,9 +290,14 @@ static bool BGM_Load(unsigned int id)
 		// Try loading a waveform track
 		bool waveform_new = false;
 		bool mid_new = false;
-		Waveform = BGM::TrackOpen(PackPath);
+		auto prefetched = PrefetchTake(PackPath);
+		if(prefetched) {
+			Waveform = std::move(prefetched->track);
+		} else {
+			Waveform = BGM::TrackOpen(PackPath);
+		}
 		if(Waveform) {
-			if(SndBackend_BGMLoad(Waveform)) {
+			if(SndBackend_BGMLoad(Waveform, crossfade)) {
 				waveform_new = true;
 				if(const auto& hash = Waveform->metadata.source_midi) {
 					mid_new = BGM_MidLoadByHash(*hash);
@@ -191,7 +309,11 @@ static bool BGM_Load(unsigned int id)
 		// Try loading a MIDI
 		if(!mid_new) {
 			PackPath += EXT_MID;
-			mid_new = BGM_MidLoadBuffer(SDL_LoadFile(PackPath.c_str()));
+			auto mid = ((prefetched && prefetched->mid)
+				? std::move(prefetched->mid)
+				: SDL_LoadFile(PackPath.c_str())
+			);
+			mid_new = (mid && BGM_MidLoadBuffer(std::move(mid)));
 		}
 
 		PackPath.resize(prefix_len);
@@ -203,14 +325,21 @@ static bool BGM_Load(unsigned int id)
 	return LoadedOriginalMIDI;
 }
 
-bool BGM_Switch(unsigned int id)
+static bool BGM_SwitchNow(unsigned int id, std::chrono::milliseconds crossfade)
 {
-	if(!Enabled) {
-		return false;
+	if(!Waveform || !Playing) {
+		crossfade = 0ms;
+	}
+	if(crossfade == 0ms) {
+		BGM_Stop();
 	}
-	BGM_Stop();
 	Waveform = nullptr;
-	const auto ret = BGM_Load(id);
+	const auto ret = BGM_Load(id, crossfade);
+
+	// The previous waveform track can't crossfade into a MIDI.
+	if((crossfade > 0ms) && !Waveform) {
+		SndBackend_BGMStop();
+	}
 	if(ret) {
 		LoadedNum = (id + 1);
 		BGM_SetTempo(BGM_GetTempo());
@@ -219,8 +348,83 @@ bool BGM_Switch(unsigned int id)
 	return ret;
 }
 
+bool BGM_Switch(unsigned int id, std::chrono::milliseconds crossfade)
+{
+	if(!Enabled) {
+		return false;
+	}
+	Pending = std::nullopt;
+	if(!PackPath.empty()) {
+		// Either prefetches this track, or queues it behind the one that is
+		// currently being prefetched.
+		PrefetchRequest(PackTrackFN(id));
+		if(PrefetchRunning()) {
+			Pending = PENDING_SWITCH{ .id = id, .crossfade = crossfade };
+			LoadedNum = (id + 1);
+			return true;
+		}
+	}
+	return BGM_SwitchNow(id, crossfade);
+}
+
+bool BGM_SwitchPending(void)
+{
+	return Pending.has_value();
+}
+
+void BGM_Prefetch(unsigned int id)
+{
+	if(!Enabled || PackPath.empty()) {
+		return;
+	}
+	auto base_fn = PackTrackFN(id);
+
+	// Must not replace the track of a pending switch.
+	if(Pending && (Prefetch.base_fn != base_fn)) {
+		Prefetch.queued = std::move(base_fn);
+		return;
+	}
+	PrefetchRequest(std::move(base_fn));
+}
+
+static void BGM_UpdateStep(void)
+{
+	if(PrefetchRunning()) {
+		return;
+	}
+	if(Pending) {
+		// The pending track might have been queued behind another one.
+		auto base_fn = PackTrackFN(Pending.value().id);
+		if(!PackPath.empty() && (Prefetch.base_fn != base_fn)) {
+			PrefetchRequest(std::move(base_fn));
+			if(PrefetchRunning()) {
+				return;
+			}
+		}
+		const auto pending = Pending.value();
+		Pending = std::nullopt;
+		BGM_SwitchNow(pending.id, pending.crossfade);
+	}
+	if(!Prefetch.queued.empty()) {
+		PrefetchRequest(std::exchange(Prefetch.queued, {}));
+	}
+}
+
+void BGM_Update(bool block)
+{
+	BGM_UpdateStep();
+	while(block && Pending) {
+		Prefetch.thread.Join();
+		BGM_UpdateStep();
+	}
+}
+
 void BGM_Play(void)
 {
+	// The pending switch will start playback once it's done.
+	if(Pending) {
+		return;
+	}
 	BGM_SetGainApply(GainApply);
 	if(Waveform) {
 		SndBackend_BGMPlay();
@@ -233,6 +437,7 @@ void BGM_Play(void)
 
 void BGM_Stop(void)
 {
+	Pending = std::nullopt;
 	if(Waveform) {
 		SndBackend_BGMStop();
 
@@ -250,6 +455,7 @@ void BGM_Pause(void)
 	// This is called when the window loses focus. Maybe the user will add a
 	// BGM pack before coming back?
 	PacksAvailable = std::nullopt;
+	PackIndexStale = true;
 
 	// Waveform tracks are automatically paused as part of the Snd subsystem
 	// once the game window loses focus. We might need independent pausing in
@@ -373,22 +579,121 @@ bool BGM_PacksAvailable(bool invalidate_cache)
 	return PacksAvailable.value();
 }
 
-size_t BGM_PackCount(void)
+void BGM_PackIndexRefresh(void)
 {
-	size_t ret = 0;
-	BGM_PackIterator([&](const std::u8string_view) {
-		ret++;
-		return SDL_ENUM_CONTINUE;
-	});
-	return ret;
+	PackIndexStale = true;
 }
 
-void BGM_PackForeach(void func(const std::u8string_view pack))
+static std::vector<PACK_INDEX_ENTRY>& PackIndexGet(void)
 {
+	if(!PackIndexStale) {
+		return PackIndex;
+	}
+	PackIndex.clear();
 	BGM_PackIterator([&](const std::u8string_view pack) {
-		func(pack);
+		PackIndex.emplace_back(std::u8string{ pack });
 		return SDL_ENUM_CONTINUE;
 	});
+	std::ranges::sort(PackIndex, {}, &PACK_INDEX_ENTRY::name);
+	PackIndexStale = false;
+	return PackIndex;
+}
+
+size_t BGM_PackCount(void)
+{
+	return PackIndexGet().size();
+}
+
+void BGM_PackForeach(void func(const std::u8string_view pack))
+{
+	for(const auto& entry : PackIndexGet()) {
+		func(entry.name);
+	}
+}
+
+// Parses the 1-based track number at the start of a pack file name.
+static std::optional<unsigned int> PackFileTrackNum(const char *basename)
+{
+	const auto digit = [](char c) -> std::optional<unsigned int> {
+		if((c < '0') || (c > '9')) {
+			return std::nullopt;
+		}
+		return (c - '0');
+	};
+	const auto tens = digit(basename[0]);
+	const auto ones = (tens ? digit(basename[1]) : std::nullopt);
+	if(!ones || (basename[2] != '.')) {
+		return std::nullopt;
+	}
+	const auto ret = ((tens.value() * 10) + ones.value());
+	if(ret == 0) {
+		return std::nullopt;
+	}
+	return ret;
+}
+
+static std::vector<BGM_TRACK_INFO> PackScanTracks(const std::u8string_view pack)
+{
+	// Relative to the current directory, just like BGM_PackIterator().
+	std::u8string base_fn;
+	base_fn += BGM_ROOT;
+	base_fn += pack;
+	base_fn += '/';
+
+	// Pack files are named after two-digit track numbers.
+	std::bitset<100> nums;
+	SDL_EnumerateDirectory(
+		std::bit_cast<const char *>(base_fn.c_str()),
+		[](void *nums, const char *, const char *basename) {
+			if(const auto num = PackFileTrackNum(basename)) {
+				static_cast<std::bitset<100> *>(nums)->set(num.value());
+			}
+			return SDL_ENUM_CONTINUE;
+		},
+		&nums
+	);
+
+	std::vector<BGM_TRACK_INFO> ret;
+	const auto prefix_len = base_fn.size();
+	for(unsigned int num = 1; num < nums.size(); num++) {
+		if(!nums.test(num)) {
+			continue;
+		}
+		base_fn.resize(prefix_len);
+		StringCatNum<2>(num, base_fn);
+		BGM_TRACK_INFO info = { .id = (num - 1) };
+		if(const auto track = BGM::TrackOpen(base_fn)) {
+			const auto loop = track->Loop().value_or(BGM::TRACK_LOOP{});
+			info.codec = track->Codec();
+			info.samplingrate = track->pcmf.samplingrate;
+			info.loop_start = loop.start;
+			info.loop_end = loop.end;
+		} else {
+			base_fn += EXT_MID;
+			const auto* fn = std::bit_cast<const char *>(base_fn.c_str());
+			if(!SDL_GetPathInfo(fn, nullptr)) {
+				continue;
+			}
+			info.codec = EXT_MID;
+		}
+		ret.emplace_back(info);
+	}
+	return ret;
+}
+
+std::span<const BGM_TRACK_INFO> BGM_PackTracks(const std::u8string_view pack)
+{
+	auto& index = PackIndexGet();
+	const auto it = std::ranges::lower_bound(
+		index, pack, {}, &PACK_INDEX_ENTRY::name
+	);
+	if((it == index.end()) || (it->name != pack)) {
+		return {};
+	}
+	if(!it->tracks) {
+		it->tracks = PackScanTracks(pack);
+	}
+	return it->tracks.value();
 }
 
 bool BGM_PackSet(const std::u8string_view pack)
@@ -428,7 +733,7 @@ bool BGM_PackSet(const std::u8string_view pack)
 		PackPath.clear();
 	}
 
-	if((LoadedNum != 0) && Playing) {
+	if((LoadedNum != 0) && (Playing || Pending)) {
 		BGM_Switch(LoadedNum - 1);
 	}
 	return true;
@@ -48,7 +48,32 @@ bool BGM_ChangeMIDIDevice(int8_t direction); // 出力デバイスを変更す
 
 // Stops the currently playing BGM, then loads and plays the track with the
 // given 0-based [id]. Returns `true` if the BGM was changed successfully.
-bool BGM_Switch(unsigned int id);
+// If [crossfade] is nonzero and both the current and the new track are
+// waveform tracks, the current one instead keeps playing and fades out while
+// the new one fades in.
+// BGM pack tracks are opened on the prefetch thread. If that thread isn't done
+// with the track yet, the switch is left pending, the current BGM keeps
+// playing, and the function returns `true`. BGM_Update() then completes the
+// switch once the track is ready, and BGM_Stop() cancels it.
+bool BGM_Switch(
+	unsigned int id,
+	std::chrono::milliseconds crossfade = std::chrono::milliseconds::zero()
+);
+
+// Returns whether a BGM_Switch() is waiting for its track to be prefetched.
+bool BGM_SwitchPending(void);
+
+// Starts opening and decoding the beginning of the BGM pack track with the
+// given 0-based [id] on a separate thread, so that a later BGM_Switch() to
+// this track doesn't stall the game. Only one track can be prefetched at a
+// time, and further requests are queued until that one is done.
+void BGM_Prefetch(unsigned int id);
+
+// Starts queued prefetches and completes any pending switch, and should be
+// called once per frame. Only blocks if [block] is `true`, in which case it
+// waits for any pending switch to complete. Offline rendering needs this to
+// start every track on the same frame, independent of the prefetch thread.
+void BGM_Update(bool block = false);
 
 void BGM_Play(void);
 void BGM_Stop(void);
@@ -92,9 +117,30 @@ void BGM_SetTempo(int8_t tempo);	// テンポを変更する
 // The result is cached and invalidated whenever BGM is paused.
 bool BGM_PacksAvailable(bool invalidate_cache = false);
 
+// The functions below work on an in-memory index of all packs that is built
+// on first use, and rebuilt on the first use after BGM_PackIndexRefresh() or
+// after BGM was paused.
+struct BGM_TRACK_INFO {
+	unsigned int id; // 0-based, as passed to BGM_Switch()
+	std::u8string_view codec; // File extension, including the dot
+
+	// All of these are 0 for MIDI tracks, and the loop positions are also 0
+	// if the codec can't determine them.
+	uint32_t samplingrate;
+	uint64_t loop_start; // In samples
+	uint64_t loop_end; // In samples
+};
+
+void BGM_PackIndexRefresh(void);
+
+// Iterates over all packs in the index, sorted by name.
 size_t BGM_PackCount(void);
 void BGM_PackForeach(void func(const std::u8string_view pack));
 
+// Returns the tracks in the given [pack], sorted by ID. Opens every track on
+// the first call for each pack after a refresh.
+std::span<const BGM_TRACK_INFO> BGM_PackTracks(const std::u8string_view pack);
+
 // Restarts any currently playing BGM when switching to a different [pack].
 // Returns `false` if the given [pack] doesn't exist, and switches to the empty
 // pack in that case.
@@ -70,7 +70,7 @@ template <class BitDepth> static void ApplyVolume(
 	}
 }
 
-bool TRACK::Decode(std::span<std::byte> buf)
+bool TRACK::DecodeRaw(std::span<std::byte> buf)
 {
 	size_t offset = 0;
 	auto size_left = buf.size_bytes();
@@ -83,6 +83,27 @@ bool TRACK::Decode(std::span<std::byte> buf)
 		offset += ret;
 		size_left -= ret;
 	}
+	return true;
+}
+
+bool TRACK::Decode(std::span<std::byte> buf)
+{
+	const auto prefetched_left = (prefetched.size() - prefetched_offset);
+	const auto from_prefetch = (std::min)(prefetched_left, buf.size_bytes());
+	if(from_prefetch > 0) {
+		std::ranges::copy_n(
+			(prefetched.begin() + prefetched_offset), from_prefetch, buf.begin()
+		);
+		prefetched_offset += from_prefetch;
+		if(prefetched_offset == prefetched.size()) {
+			prefetched = {};
+			prefetched_offset = 0;
+		}
+	}
+	if(!DecodeRaw(buf.subspan(from_prefetch))) {
+		std::ranges::fill(buf, std::byte{ 0 });
+		return false;
+	}
 
 	if(vol.FadeVolumeLinear() != 1.0f) {
 		const auto apply_volume = (
@@ -95,6 +116,18 @@ bool TRACK::Decode(std::span<std::byte> buf)
 	return true;
 }
 
+bool TRACK::Prefetch(std::chrono::milliseconds duration)
+{
+	const auto samples = ((duration.count() * pcmf.samplingrate) / 1000);
+	const auto prev_size = prefetched.size();
+	prefetched.resize(prev_size + (samples * pcmf.SampleSize()));
+	if(!DecodeRaw(std::span(prefetched).subspan(prev_size))) {
+		prefetched.resize(prev_size);
+		return false;
+	}
+	return true;
+}
+
 void TRACK::FadeOut(float volume_start, std::chrono::milliseconds duration)
 {
 	const auto sample_count = ((duration.count() * pcmf.samplingrate) / 1000);
@@ -117,6 +150,30 @@ size_t TRACK_PCM::DecodeSingle(std::span<std::byte> buf)
 	return ret;
 }
 
+std::u8string_view TRACK_PCM::Codec(void) const
+{
+	return codec;
+}
+
+std::optional<TRACK_LOOP> TRACK_PCM::Loop(void)
+{
+	const auto intro_len = intro_part->PartLength();
+	if(!intro_len) {
+		return std::nullopt;
+	}
+	if(!loop_part) {
+		return TRACK_LOOP{ .start = 0, .end = intro_len.value() };
+	}
+	const auto loop_len = loop_part->PartLength();
+	if(!loop_len) {
+		return std::nullopt;
+	}
+	return TRACK_LOOP{
+		.start = intro_len.value(),
+		.end = (intro_len.value() + loop_len.value()),
+	};
+}
+
 TRACK_PCM::~TRACK_PCM()
 {
 	SDL_CloseIO(loop_stream);
@@ -243,6 +300,7 @@ std::unique_ptr<TRACK> TrackOpen(const std::u8string_view base_fn)
 		}
 		return std::make_unique<TRACK_PCM>(
 			std::move(meta),
+			codec.ext,
 			*intro_stream,
 			loop_stream,
 			std::move(intro_part),
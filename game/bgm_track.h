@@ -41,6 +41,11 @@ void OnVorbisComment(METADATA_CALLBACK func, const std::u8string_view comment);
 // Base class for a track
 // ----------------------
 
+struct TRACK_LOOP {
+	uint64_t start;
+	uint64_t end;
+};
+
 class TRACK_VOL {
 	float volume_linear = 1.0f;
 	float volume_factor = 1.0f;
@@ -68,6 +73,14 @@ struct TRACK {
 protected:
 	TRACK_VOL vol;
 
+	// Samples decoded ahead of time by Prefetch(), which Decode() returns
+	// before decoding any new ones.
+	std::vector<std::byte> prefetched;
+	size_t prefetched_offset = 0;
+
+	// Fills [buf] entirely, without applying the volume.
+	bool DecodeRaw(std::span<std::byte> buf);
+
 public:
 	const TRACK_METADATA metadata;
 
@@ -84,6 +97,11 @@ public:
 	// filled with zeroes.
 	bool Decode(std::span<std::byte> buf);
 
+	// Decodes the given duration from the current position ahead of time,
+	// so that the first Decode() calls don't need to touch the codec. Meant to
+	// be called on a separate thread before the track starts playing.
+	bool Prefetch(std::chrono::milliseconds duration);
+
 	auto FadeVolumeLinear() const {
 		return vol.FadeVolumeLinear();
 	}
@@ -91,6 +109,14 @@ public:
 	// Starts a fade-out that takes the given number of milliseconds.
 	void FadeOut(float volume_start, std::chrono::milliseconds duration);
 
+	// Returns the file extension of the codec used by this track.
+	virtual std::u8string_view Codec(void) const = 0;
+
+	// Returns the sample positions that playback loops between, or
+	// `std::nullopt` if the codec can't determine them without decoding the
+	// entire track.
+	virtual std::optional<TRACK_LOOP> Loop(void) = 0;
+
 	TRACK(TRACK_METADATA&& metadata, const PCM_FORMAT& pcmf) :
 		metadata(metadata), pcmf(pcmf) {
 	}
@@ -115,6 +141,10 @@ struct PCM_PART {
 	// the total number of samples in the stream.
 	virtual void PartSeekToSample(size_t sample) = 0;
 
+	// Returns the total number of decoded samples in the stream, or
+	// `std::nullopt` if the stream doesn't store it.
+	virtual std::optional<uint64_t> PartLength(void) = 0;
+
 	PCM_PART(const PCM_FORMAT& pcmf) : pcmf(pcmf) {
 	}
 	virtual ~PCM_PART() {}
@@ -123,6 +153,7 @@ struct PCM_PART {
 // Generic implementation for PCM-based codecs, with separate intro and loop
 // files.
 struct TRACK_PCM : public TRACK {
+	const std::u8string_view codec;
 	SDL_IOStream& intro_stream;
 	SDL_IOStream *loop_stream;
 	std::unique_ptr<PCM_PART> intro_part;
@@ -130,15 +161,19 @@ struct TRACK_PCM : public TRACK {
 	PCM_PART* cur;
 
 	virtual size_t DecodeSingle(std::span<std::byte> buf) override;
+	virtual std::u8string_view Codec(void) const override;
+	virtual std::optional<TRACK_LOOP> Loop(void) override;
 
 	TRACK_PCM(
 		TRACK_METADATA&& metadata,
+		std::u8string_view codec,
 		SDL_IOStream& intro_stream,
 		SDL_IOStream *loop_stream,
 		std::unique_ptr<PCM_PART> intro_part,
 		std::unique_ptr<PCM_PART> loop_part
 	) :
 		TRACK(std::move(metadata), intro_part->pcmf),
+		codec(codec),
 		intro_stream(intro_stream),
 		loop_stream(loop_stream),
 		intro_part(std::move(intro_part)),
@@ -121,6 +121,7 @@ struct PCM_PART_FLAC : public PCM_PART {
 
 	size_t PartDecodeSingle(std::span<std::byte> buf) override;
 	void PartSeekToSample(size_t sample) override;
+	std::optional<uint64_t> PartLength(void) override;
 
 	PCM_PART_FLAC(
 		drflac* ff, const PCM_FORMAT& pcmf, drflac_read_func_t& read_func
@@ -141,6 +142,15 @@ void PCM_PART_FLAC::PartSeekToSample(size_t sample)
 	drflac_seek_to_pcm_frame(ff, sample);
 }
 
+std::optional<uint64_t> PCM_PART_FLAC::PartLength(void)
+{
+	// STREAMINFO uses 0 for an unknown length.
+	if(ff->totalPCMFrameCount == 0) {
+		return std::nullopt;
+	}
+	return ff->totalPCMFrameCount;
+}
+
 PCM_PART_FLAC::~PCM_PART_FLAC()
 {
 	drflac_close(ff);
@@ -60,6 +60,7 @@ struct PCM_PART_VORBIS : public BGM::PCM_PART {
 
 	size_t PartDecodeSingle(std::span<std::byte> buf) override;
 	void PartSeekToSample(size_t sample) override;
+	std::optional<uint64_t> PartLength(void) override;
 
 	PCM_PART_VORBIS(OggVorbis_File&& vf, const PCM_FORMAT& pcmf) :
 		vf(vf), PCM_PART(pcmf) {
@@ -80,6 +81,15 @@ void PCM_PART_VORBIS::PartSeekToSample(size_t sample)
 	assert(ret == 0);
 }
 
+std::optional<uint64_t> PCM_PART_VORBIS::PartLength(void)
+{
+	const auto ret = ov_pcm_total(&vf, -1);
+	if(ret < 0) {
+		return std::nullopt;
+	}
+	return static_cast<uint64_t>(ret);
+}
+
 PCM_PART_VORBIS::~PCM_PART_VORBIS()
 {
 	ov_clear(&vf);
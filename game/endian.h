@@ -60,6 +60,8 @@ using I16LE = ENDIAN_SELECT_LITTLE<int16_t>;
 using U16LE = ENDIAN_SELECT_LITTLE<uint16_t>;
 using I32LE = ENDIAN_SELECT_LITTLE<int32_t>;
 using U32LE = ENDIAN_SELECT_LITTLE<uint32_t>;
+using I64LE = ENDIAN_SELECT_LITTLE<int64_t>;
+using U64LE = ENDIAN_SELECT_LITTLE<uint64_t>;
 using I16BE = ENDIAN_SELECT_BIG<int16_t>;
 using U16BE = ENDIAN_SELECT_BIG<uint16_t>;
 using I32BE = ENDIAN_SELECT_BIG<int32_t>;
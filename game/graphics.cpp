@@ -18,25 +18,27 @@
 #include "platform/file.h"
 #include "platform/path.h"
 #include "platform/graphics_backend.h"
+#include "platform/thread.h"
 
 uint8_t Grp_FPSDivisor = 0;
-std::chrono::steady_clock::duration Grp_ScreenshotTimes[
+std::atomic<std::chrono::steady_clock::duration> Grp_ScreenshotTimes[
 	GRP_SCREENSHOT_EFFORT_COUNT
 ];
 
 // Paletted graphics //
 // ----------------- //
 
-PALETTE PALETTE::Fade(uint8_t alpha, uint8_t first, uint8_t last) const
+PALETTE PALETTE::Fade(
+	uint16_t brightness, uint8_t first, uint8_t last
+) const
 {
 	PALETTE ret = *this;
-	const uint16_t a16 = alpha;
 	const auto src_end = (cbegin() + last + 1);
 	for(auto src_it = (cbegin() + first); src_it < src_end; src_it++) {
 		ret[src_it - cbegin()] = RGBA{
-			.r = static_cast<uint8_t>((src_it->r * a16) / 255),
-			.g = static_cast<uint8_t>((src_it->g * a16) / 255),
-			.b = static_cast<uint8_t>((src_it->b * a16) / 255),
+			.r = BrightnessApply(src_it->r, brightness),
+			.g = BrightnessApply(src_it->g, brightness),
+			.b = BrightnessApply(src_it->b, brightness),
 		};
 	}
 	return ret;
@@ -63,6 +65,47 @@ void Grp_PaletteSetDefault(void)
 
 using NUM_TYPE = unsigned int;
 
+// Encoding runs on a small pool of worker threads. Each screenshot is copied
+// before being queued, and the game only waits if this many screenshots are
+// still being encoded.
+constexpr unsigned int SCREENSHOT_WORKERS_MAX = 4;
+constexpr unsigned int SCREENSHOTS_IN_FLIGHT = 4;
+
+// An output file, created on the frame thread before encoding. This way, the
+// file numbers follow the order in which the screenshots were taken, not the
+// order in which the workers finish encoding them.
+struct SCREENSHOT_FILE {
+	NUM_TYPE num;
+	SDL_IOStream *stream;
+};
+
+struct SCREENSHOT_JOB {
+	SDL_Surface *surface;
+	SCREENSHOT_FILE file;
+	uint8_t effort;
+	std::chrono::steady_clock::time_point t_start;
+};
+
+static struct {
+	std::deque<SCREENSHOT_JOB> queue;
+	unsigned int in_flight = 0;
+	bool closing = false;
+
+	// Screenshots that failed on a worker since the last flush.
+	unsigned int failed = 0;
+
+	// Set by Grp_ScreenshotSetWorkers(). Defaults to one less than the number
+	// of cores, leaving one for the game itself.
+	std::optional<unsigned int> workers_requested;
+
+	std::mutex mutex;
+	std::condition_variable cv;
+	std::vector<THREAD> workers;
+} ScreenshotPool;
+
+// Guards the screenshot number and file name, which are shared between all
+// workers.
+static std::mutex ScreenshotStreamMutex;
 static NUM_TYPE ScreenshotNum = 0;
 static std::u8string ScreenshotBuf;
 
@@ -90,52 +133,82 @@ static void ScreenshotFindLastFor(std::u8string_view ext)
 
 void Grp_ScreenshotSetPrefix(std::u8string_view prefix)
 {
+	std::lock_guard lock{ ScreenshotStreamMutex };
 	const auto cap = (prefix.length() + STRING_NUM_CAP<NUM_TYPE> + 5);
 	ScreenshotBuf.resize_and_overwrite(cap, [&](auto *p, size_t) {
 		return (std::ranges::copy(prefix, p).out - p);
 	});
 }
 
+// Calls [func] with the file name of screenshot [num] with the given
+// extension. Must be called with [ScreenshotStreamMutex] held.
+template <class F> static auto ScreenshotWithFN(
+	NUM_TYPE num, std::u8string_view ext, F&& func
+) {
+	const auto prefix_len = ScreenshotBuf.size();
+	StringCatNum<4>(num, ScreenshotBuf);
+	ScreenshotBuf += ext;
+	defer(ScreenshotBuf.resize(prefix_len));
+	return func(ScreenshotBuf.c_str());
+}
+
 // Increments the screenshot number to the next file with the given extension
 // that doesn't exist yet, then opens a write stream for that file.
-SDL_IOStream* Grp_NextScreenshotStream(std::u8string_view ext)
+static SCREENSHOT_FILE ScreenshotFileNext(std::u8string_view ext)
 {
+	std::lock_guard lock{ ScreenshotStreamMutex };
 	if(ScreenshotBuf.size() == 0) {
-		return nullptr;
+		return { .stream = nullptr };
 	}
 
 	// Users might delete the directory while the game is running, after all.
 	if(!SDL_CreateDirectory(ScreenshotBuf.c_str())) {
 		ScreenshotBuf.clear();
-		return nullptr;
+		return { .stream = nullptr };
 	}
 
 	// Prevent the theoretical infinite loop...
 	while(ScreenshotNum < (std::numeric_limits<NUM_TYPE>::max)()) {
-		const auto prefix_len = ScreenshotBuf.size();
-		StringCatNum<4>(ScreenshotNum++, ScreenshotBuf);
-		ScreenshotBuf += ext;
-		auto *ret = SDL_IOFromFile(ScreenshotBuf.c_str(), "wxb");
-		ScreenshotBuf.resize(prefix_len);
+		const auto num = ScreenshotNum++;
+		auto *ret = ScreenshotWithFN(num, ext, [](const char8_t *fn) {
+			return SDL_IOFromFile(fn, "wxb");
+		});
 		if(ret) {
-			return ret;
+			return { .num = num, .stream = ret };
 		}
 		if(ScreenshotNum == 1) {
 			ScreenshotFindLastFor(ext);
 		}
 	}
-	return nullptr;
+	return { .stream = nullptr };
 }
 
-static bool ScreenshotSaveBMP(SDL_Surface *src)
+// Replaces the WebP file reserved for a screenshot with a .BMP file of the
+// same number, or the next free one if that already exists.
+static SCREENSHOT_FILE ScreenshotFileFallbackBMP(SCREENSHOT_FILE file)
+{
+	SDL_CloseIO(file.stream);
+	{
+		std::lock_guard lock{ ScreenshotStreamMutex };
+		if(ScreenshotBuf.size() == 0) {
+			return { .stream = nullptr };
+		}
+		ScreenshotWithFN(file.num, u8".webp", [](const char8_t *fn) {
+			return SDL_RemovePath(std::bit_cast<const char *>(fn));
+		});
+		file.stream = ScreenshotWithFN(file.num, u8".BMP", [](
+			const char8_t *fn
+		) {
+			return SDL_IOFromFile(fn, "wxb");
+		});
+	}
+	return (file.stream ? file : ScreenshotFileNext(u8".BMP"));
+}
+
+static bool ScreenshotSaveBMP(SDL_IOStream *stream, SDL_Surface *src)
 {
 	assert(src->w < std::numeric_limits<PIXEL_COORD>::max());
 	assert(src->h < std::numeric_limits<PIXEL_COORD>::max());
-	const auto stream = Grp_NextScreenshotStream(u8".BMP");
-	if(!stream) {
-		return false;
-	}
-	defer(SDL_CloseIO(stream));
 
 	// SDL_SaveBMP_IO() is very slow and unoptimized, especially on Windows
 	// where SDL_IOStream still uses unbuffered writes as of SDL 3.2.24. For
@@ -174,7 +247,12 @@ static bool ScreenshotSaveBMP(SDL_Surface *src)
 	return BMPSave(stream, bmp_size, 1, bpp, palette, pixels);
 }
 
-static bool ScreenshotSaveWebP(SDL_Surface *src, int z)
+// [z] is the libwebp lossless preset level. [threaded] lets libwebp analyze
+// the image on an additional thread, which only helps if no other screenshots
+// are being encoded at the same time.
+static bool ScreenshotSaveWebP(
+	SDL_IOStream *stream, SDL_Surface *src, int z, bool threaded
+)
 {
 	if((src->w > WEBP_MAX_DIMENSION) || (src->h > WEBP_MAX_DIMENSION)) {
 		return false;
@@ -261,7 +339,7 @@ static bool ScreenshotSaveWebP(SDL_Surface *src, int z)
 	if(!WebPConfigLosslessPreset(&config, z)) {
 		return false;
 	}
-	config.thread_level = 1;
+	config.thread_level = threaded;
 
 	WebPMemoryWriter wrt;
 	WebPMemoryWriterInit(&wrt);
@@ -273,45 +351,160 @@ static bool ScreenshotSaveWebP(SDL_Surface *src, int z)
 	if(!ret) {
 		return false;
 	}
-	const auto stream = Grp_NextScreenshotStream(u8".webp");
-	if(!stream) {
-		return false;
-	}
-	defer(SDL_CloseIO(stream));
 	return SDL_MustWriteIO(stream, wrt.mem, wrt.size);
 }
 
-bool Grp_ScreenshotSave(
-	SDL_Surface *src, const std::chrono::steady_clock::time_point t_start
-)
+// Encodes and writes [job.surface] into [job.file] at the job's effort,
+// falling back on .BMP if WebP encoding fails, and records the latency since
+// [job.t_start]. Closes the file.
+static bool ScreenshotEncode(const SCREENSHOT_JOB& job, bool threaded)
 {
 	constexpr auto DURATION_FAILED = std::chrono::steady_clock::duration(-1);
 
-	assert(src->w >= 0);
-	assert(src->h >= 0);
-	if(SDL_MUSTLOCK(src)) {
-		SDL_LockSurface(src);
-	}
-
+	auto file = job.file;
+	auto effort = job.effort;
 	auto ret = false;
-	auto effort = Grp_ScreenshotEffort;
 	if(effort != 0) {
-		ret = ScreenshotSaveWebP(src, (effort - 1));
+		ret = ScreenshotSaveWebP(
+			file.stream, job.surface, (effort - 1), threaded
+		);
 		if(!ret) {
 			Grp_ScreenshotTimes[effort] = DURATION_FAILED;
+			file = ScreenshotFileFallbackBMP(file);
 		}
 	}
-	if(!ret) {
+	if(!ret && file.stream) {
 		effort = 0;
-		ret = ScreenshotSaveBMP(src);
+		ret = ScreenshotSaveBMP(file.stream, job.surface);
+	}
+	if(file.stream) {
+		ret = (SDL_CloseIO(file.stream) && ret);
 	}
 	const auto t_end = std::chrono::steady_clock::now();
-	Grp_ScreenshotTimes[effort] = (ret ? (t_end - t_start) : DURATION_FAILED);
+	const auto time = (t_end - job.t_start);
+	Grp_ScreenshotTimes[effort] = (ret ? time : DURATION_FAILED);
+	return ret;
+}
+
+static void ScreenshotWorker(const THREAD_STOP&)
+{
+	auto& pool = ScreenshotPool;
+	while(true) {
+		std::unique_lock lock{ pool.mutex };
+		pool.cv.wait(lock, [&] {
+			return (pool.closing || !pool.queue.empty());
+		});
+		if(pool.queue.empty()) {
+			return;
+		}
+		const auto job = pool.queue.front();
+		pool.queue.pop_front();
+
+		// libwebp's own threading would only compete with the other workers.
+		const auto threaded = (pool.in_flight == 1);
+		lock.unlock();
+
+		const auto ret = ScreenshotEncode(job, threaded);
+		SDL_DestroySurface(job.surface);
+
+		lock.lock();
+		pool.failed += !ret;
+		pool.in_flight--;
+		pool.cv.notify_all();
+	}
+}
+
+// Starts the worker threads if necessary. Returns `false` if none could be
+// started, or none were requested.
+static bool ScreenshotPoolStart(void)
+{
+	auto& pool = ScreenshotPool;
+	if(!pool.workers.empty()) {
+		return true;
+	}
+
+	// Leave one core for the game itself.
+	const auto cores = std::thread::hardware_concurrency();
+	const auto count = pool.workers_requested.value_or(std::clamp(
+		((cores > 1) ? (cores - 1) : 1), 1u, SCREENSHOT_WORKERS_MAX
+	));
+	pool.closing = false;
+	for(unsigned int i = 0; i < count; i++) {
+		auto thread = ThreadStart(ScreenshotWorker);
+		if(!thread.Joinable()) {
+			break;
+		}
+		pool.workers.emplace_back(std::move(thread));
+	}
+	return !pool.workers.empty();
+}
+
+bool Grp_ScreenshotSave(
+	SDL_Surface *src,
+	const std::chrono::steady_clock::time_point t_start,
+	uint8_t effort
+)
+{
+	assert(src->w >= 0);
+	assert(src->h >= 0);
+	const auto file = ScreenshotFileNext((effort == 0) ? u8".BMP" : u8".webp");
+	if(!file.stream) {
+		return false;
+	}
+
+	if(SDL_MUSTLOCK(src)) {
+		SDL_LockSurface(src);
+	}
+	auto *copy = (ScreenshotPoolStart() ? SDL_DuplicateSurface(src) : nullptr);
 
+	// Without a copy, we still have the original and can encode it right away.
+	auto ret = true;
+	if(!copy) {
+		ret = ScreenshotEncode({ src, file, effort, t_start }, true);
+	}
 	if(SDL_MUSTLOCK(src)) {
 		SDL_UnlockSurface(src);
 	}
+	if(!copy) {
+		return ret;
+	}
 
+	auto& pool = ScreenshotPool;
+	{
+		std::unique_lock lock{ pool.mutex };
+		pool.cv.wait(lock, [&] {
+			return (pool.in_flight < SCREENSHOTS_IN_FLIGHT);
+		});
+		pool.queue.emplace_back(copy, file, effort, t_start);
+		pool.in_flight++;
+	}
+	pool.cv.notify_all();
+	return true;
+}
+
+bool Grp_ScreenshotFlush(void)
+{
+	auto& pool = ScreenshotPool;
+	{
+		std::lock_guard lock{ pool.mutex };
+		pool.closing = true;
+	}
+	pool.cv.notify_all();
+	for(auto& worker : pool.workers) {
+		worker.Join();
+	}
+	pool.workers.clear();
+
+	std::lock_guard lock{ pool.mutex };
+	const auto ret = (pool.failed == 0);
+	pool.failed = 0;
+	return ret;
+}
+
+bool Grp_ScreenshotSetWorkers(std::optional<unsigned int> count)
+{
+	const auto ret = Grp_ScreenshotFlush();
+	ScreenshotPool.workers_requested = count;
 	return ret;
 }
 // -----------
@@ -432,7 +625,13 @@ std::optional<GRAPHICS_INIT_RESULT> Grp_InitOrFallback(GRAPHICS_PARAMS params)
 	return std::nullopt;
 }
 
+static bool ScreenshotEnabled(void)
+{
+	std::lock_guard lock{ ScreenshotStreamMutex };
+	return (ScreenshotBuf.size() != 0);
+}
+
 void Grp_Flip(void)
 {
-	GrpBackend_Flip((SystemKey_Data & SYSKEY_SNAPSHOT) && ScreenshotBuf.size());
+	GrpBackend_Flip((SystemKey_Data & SYSKEY_SNAPSHOT) && ScreenshotEnabled());
 }
@@ -35,11 +35,31 @@ struct RGB {
 };
 static_assert(sizeof(RGB) == 3);
 
+// Brightness levels for fades. Up to [BRIGHTNESS_NORMAL], colors fade to
+// black, and above, they fade to white, which they reach at [BRIGHTNESS_WHITE].
+constexpr uint16_t BRIGHTNESS_NORMAL = 255;
+constexpr uint16_t BRIGHTNESS_WHITE = (BRIGHTNESS_NORMAL * 2);
+
+// Applies [brightness] to a single color channel. Rounds in the same way as
+// both SDL's color modulation and its alpha blending of a white box.
+constexpr uint8_t BrightnessApply(uint8_t c, uint16_t brightness)
+{
+	if(brightness <= BRIGHTNESS_NORMAL) {
+		return static_cast<uint8_t>((c * brightness) / 255);
+	}
+	const auto white = (
+		(std::min)(brightness, BRIGHTNESS_WHITE) - BRIGHTNESS_NORMAL
+	);
+	return static_cast<uint8_t>(white + (((255 - white) * c) / 255));
+}
+
 struct PALETTE : public std::array<RGBA, 256> {
-	// Builds a new palette with the given fade [alpha] value applied onto the
-	// given inclusive (!) range of colors. Returns the rest of the palette
+	// Builds a new palette with the given [brightness] applied onto the given
+	// inclusive (!) range of colors. Returns the rest of the palette
 	// unchanged.
-	PALETTE Fade(uint8_t alpha, uint8_t first = 0, uint8_t last = 255) const;
+	PALETTE Fade(
+		uint16_t brightness, uint8_t first = 0, uint8_t last = 255
+	) const;
 };
 
 // (6 * 6 * 6) = 216 standard colors, available in both channeled and
@@ -116,8 +136,10 @@ constexpr uint8_t GRP_SCREENSHOT_EFFORT_MAX = (GRP_SCREENSHOT_EFFORT_COUNT - 1);
 
 extern const uint8_t& Grp_ScreenshotEffort;
 
-// 0 = not yet tried, -1 = last attempt failed.
-extern std::chrono::steady_clock::duration Grp_ScreenshotTimes[
+// Time from the start of capturing to the finished file, as measured for the
+// last screenshot at each effort level. 0 = not yet tried, -1 = last attempt
+// failed. Written by the encoding threads.
+extern std::atomic<std::chrono::steady_clock::duration> Grp_ScreenshotTimes[
 	GRP_SCREENSHOT_EFFORT_COUNT
 ];
 
@@ -126,11 +148,31 @@ void Grp_ScreenshotSetPrefix(std::u8string_view prefix);
 
 struct SDL_Surface;
 
-// Saves the given surface to a file with the screenshot prefix. [t_start]
-// represents the very beginning of the backend's capturing process.
+// Saves the given surface to a file with the screenshot prefix, using the
+// given effort level. [t_start] represents the very beginning of the backend's
+// capturing process.
+// The output file is created immediately, so that file numbers follow the
+// order of these calls. The surface is then copied and encoded on a worker
+// thread, so the caller can reuse or destroy it right away. Returns `false`
+// if the file could not be created, or if the surface could not be copied and
+// encoding it directly failed. Failures on the worker threads are reported
+// through [Grp_ScreenshotTimes] and Grp_ScreenshotFlush().
 bool Grp_ScreenshotSave(
-	SDL_Surface *src, const std::chrono::steady_clock::time_point t_start
+	SDL_Surface *src,
+	const std::chrono::steady_clock::time_point t_start,
+	uint8_t effort = Grp_ScreenshotEffort
 );
+
+// Waits for all queued screenshots to be written and stops the worker
+// threads. Returns `false` if any screenshot failed on a worker thread since
+// the last call.
+bool Grp_ScreenshotFlush(void);
+
+// Flushes the queue, and sets the number of worker threads that will encode
+// future screenshots. 0 encodes them directly within Grp_ScreenshotSave(),
+// and `std::nullopt` restores the default of one less than the number of CPU
+// cores, up to 4. Returns the result of the flush.
+bool Grp_ScreenshotSetWorkers(std::optional<unsigned int> count);
 // -----------
 
 enum class GRAPHICS_FULLSCREEN_FIT : uint8_t {
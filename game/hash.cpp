@@ -25,3 +25,77 @@ HASH Hash(const BYTE_BUFFER_BORROWED& buffer)
 	);
 	return ret;
 }
+
+std::vector<std::optional<HASH>> HashParallel(
+	size_t count,
+	const std::function<BYTE_BUFFER_OWNED(size_t i)>& load,
+	const THREAD_STOP& st
+)
+{
+	// Hashing on its own is already vectorized by BLAKE3 and mostly bound by
+	// memory bandwidth, so more threads than this don't help.
+	constexpr unsigned int THREADS_MAX = 8;
+
+	std::vector<std::optional<HASH>> ret(count);
+	std::atomic<size_t> next = 0;
+	const auto work = [&](const THREAD_STOP&) {
+		size_t i;
+		while(!st && ((i = next.fetch_add(1)) < count)) {
+			if(const auto buf = load(i)) {
+				ret[i] = Hash({ buf.get(), buf.size() });
+			}
+		}
+	};
+
+	const auto threads_wanted = std::clamp(
+		std::thread::hardware_concurrency(), 1u, THREADS_MAX
+	);
+	const auto helpers = ((std::min)(size_t{ threads_wanted }, count) - 1);
+	std::vector<THREAD> threads;
+	threads.reserve(helpers);
+	for(size_t i = 0; i < helpers; i++) {
+		threads.emplace_back(ThreadStart(work));
+	}
+	work(st);
+	for(auto& thread : threads) {
+		thread.Join();
+	}
+	return ret;
+}
+
+HASH_TRAILER HashTrailer(const BYTE_BUFFER_BORROWED& data)
+{
+	HASH_TRAILER ret;
+	const auto hash = Hash(data);
+	const auto magic = std::ranges::transform(hash, ret.begin(), [](auto b) {
+		return std::to_integer<uint8_t>(b);
+	}).out;
+	std::ranges::copy(HASH_TRAILER_MAGIC, magic);
+	return ret;
+}
+
+std::optional<BYTE_BUFFER_BORROWED> HashTrailerVerify(
+	const BYTE_BUFFER_BORROWED& buf, bool required
+)
+{
+	const auto has_trailer = (
+		(buf.size() >= std::tuple_size_v<HASH_TRAILER>) &&
+		std::ranges::equal(
+			buf.last(HASH_TRAILER_MAGIC.size()), HASH_TRAILER_MAGIC
+		)
+	);
+	if(!has_trailer) {
+		if(required) {
+			return std::nullopt;
+		}
+		return buf;
+	}
+	const BYTE_BUFFER_BORROWED data = buf.first(
+		buf.size() - std::tuple_size_v<HASH_TRAILER>
+	);
+	const auto trailer = HashTrailer(data);
+	if(!std::ranges::equal(buf.subspan(data.size()), trailer)) {
+		return std::nullopt;
+	}
+	return data;
+}
@@ -7,6 +7,7 @@
 
 #include "game/narrow.h"
 #include "platform/buffer.h"
+#include "platform/thread.h"
 
 using HASH = std::array<std::byte, 32>;
 
@@ -34,9 +35,56 @@ static constexpr std::optional<HASH> HashFrom(Narrow::string_view str)
 	return ret;
 }
 
+// Inverse of HashFrom(), with lowercase digits.
+static constexpr auto HashHex(const HASH& hash)
+{
+	constexpr char DIGITS[] = "0123456789abcdef";
+	std::array<char, (std::tuple_size_v<HASH> * 2)> ret;
+	for(size_t i = 0; i < hash.size(); i++) {
+		const auto byte = std::to_integer<uint8_t>(hash[i]);
+		ret[(i * 2) + 0] = DIGITS[byte >> 4];
+		ret[(i * 2) + 1] = DIGITS[byte & 0xF];
+	}
+	return ret;
+}
+
 // Hashes the given buffer.
 HASH Hash(const BYTE_BUFFER_BORROWED& buffer);
 
+// Loads and hashes [count] buffers on all available cores, with the calling
+// thread doing its share of the work. [load] is called once for every index
+// from any of these threads, and must therefore be thread-safe. Hashes of
+// buffers that [load] fails to return, or that weren't reached before [st]
+// was set, are `std::nullopt`.
+std::vector<std::optional<HASH>> HashParallel(
+	size_t count,
+	const std::function<BYTE_BUFFER_OWNED(size_t i)>& load,
+	const THREAD_STOP& st
+);
+
+// Checksum trailers
+// -----------------
+// Appended to save files whose readers in the original game only parse as
+// much data as they expect, and ignore anything after that.
+
+constexpr std::array<uint8_t, 8> HASH_TRAILER_MAGIC = {
+	'S', 'S', 'G', 'B', 'L', 'A', 'K', '3'
+};
+using HASH_TRAILER = std::array<
+	uint8_t, (std::tuple_size_v<HASH> + HASH_TRAILER_MAGIC.size())
+>;
+
+// Returns the trailer to append to [data].
+HASH_TRAILER HashTrailer(const BYTE_BUFFER_BORROWED& data);
+
+// Returns the data in front of the trailer at the end of [buf] if the hash in
+// the trailer matches, or `std::nullopt` if it doesn't. Buffers without a
+// trailer are rejected if it is [required], and returned unchanged otherwise.
+std::optional<BYTE_BUFFER_BORROWED> HashTrailerVerify(
+	const BYTE_BUFFER_BORROWED& buf, bool required
+);
+// -----------------
+
 constexpr HASH operator ""_B3(const char* str, size_t len)
 {
 	const auto ret = HashFrom(Narrow::string_view{ str, len });
@@ -41,6 +41,10 @@ enum class MID_EVENT_KIND : uint8_t {
 // -------------
 
 static constexpr uint8_t MIDI_CHANNELS = 16;
+
+// Registered Parameter Numbers whose Data Entry values are restored when
+// seeking: Pitch Bend Sensitivity, Fine Tuning, and Coarse Tuning.
+static constexpr uint8_t MIDI_RPNS_TRACKED = 3;
 // -------------
 
 // Standard MIDI File format
@@ -185,18 +189,103 @@ struct MID_TRACK {
 	void ConsumeDelta(const MID_TEMPO& tempo, const MID_LOOP& loop);
 };
 
+// Seeking
+// -------
+
+static constexpr MID_REALTIME QN_DURATION_DEFAULT = 1s; // 60 BPM
+
+// Controller, program, and pitch bend state of a single channel, as far as it
+// can be reconstructed from the sequence alone.
+struct MID_CHANNEL_STATE {
+	static constexpr uint8_t UNSET = 0xFF;
+
+	std::array<uint8_t, 128> controllers;
+	std::array<uint8_t, MIDI_RPNS_TRACKED> rpn_data;
+	uint8_t rpn_msb = UNSET;
+	uint8_t rpn_lsb = UNSET;
+	uint8_t program = UNSET;
+	uint8_t bend_lsb = UNSET;
+	uint8_t bend_msb = UNSET;
+
+	MID_CHANNEL_STATE() {
+		controllers.fill(UNSET);
+		rpn_data.fill(UNSET);
+	}
+
+	void Apply(const MID_EVENT& event);
+
+	// Resets the channel on the output device and sends the complete state,
+	// with the given [volume] instead of the raw Channel Volume value.
+	void Send(uint8_t ch, VOLUME volume) const;
+};
+
+using MID_CHANNEL_STATES = std::array<MID_CHANNEL_STATE, MIDI_CHANNELS>;
+
+struct MID_TIMELINE_EVENT {
+	MID_PULSE pulse;
+
+	// Absolute time of the event at the sequence's own tempo, and the quarter
+	// note duration in effect *after* the event has been processed.
+	MID_REALTIME time;
+	MID_REALTIME qn_duration;
+
+	size_t track;
+
+	// Positioned directly at the event, after its delta time.
+	MID_TRACK_ITERATOR it;
+
+	MID_EVENT event;
+};
+
+struct MID_TIMELINE_SNAPSHOT {
+	// Channel state *before* processing the event at this index.
+	size_t event_index;
+	MID_CHANNEL_STATES channels;
+};
+
+// All events of a sequence, parsed once and merged across all tracks, for
+// seeking in logarithmic rather than linear time.
+struct MID_TIMELINE {
+	// Number of events between two channel state snapshots. Seeking replays
+	// at most this many events on top of the closest one.
+	static constexpr size_t SNAPSHOT_INTERVAL = 256;
+
+	// Sorted by pulse, then by track, then by their order within the track.
+	std::vector<MID_TIMELINE_EVENT> events;
+
+	// Indices into [events], per track.
+	std::vector<std::vector<size_t>> track_events;
+
+	std::vector<MID_TIMELINE_SNAPSHOT> snapshots;
+	uint16_t ppqn = 0;
+
+	void Build(std::span<const MID_TRACK> tracks, uint16_t ppqn_new);
+
+	// Returns the index of the first event at or after [pulse].
+	size_t FirstEventAt(MID_PULSE pulse) const;
+
+	// Returns the tempo in effect right before the event at index [i].
+	MID_TEMPO TempoBefore(size_t i) const;
+
+	MID_REALTIME RealtimeAt(MID_PULSE pulse) const;
+	MID_PULSE PulseAt(MID_REALTIME realtime) const;
+};
+// -------
+
 struct MID_SEQUENCE {
 	BYTE_BUFFER_OWNED smf = nullptr;
 	std::unique_ptr<MID_TRACK[]> track_buf = nullptr;
 	std::span<MID_TRACK> tracks;
-	MID_TEMPO tempo = { .qn_duration = 1s /* 60 BPM */ };
+	MID_TEMPO tempo = { .qn_duration = QN_DURATION_DEFAULT };
 	MID_LOOP loop;
+	MID_TIMELINE timeline;
 
 	// Applies the event to the sequence state and consumes the following delta
 	// time on the given track.
 	void Process(MID_TRACK& track, const MID_EVENT& event);
 
 	void Rewind(void);
+	void Seek(MID_PULSE target);
 };
 
 
@@ -214,6 +303,10 @@ uint8_t Mid_VolumeTable[16];	// ボリューム
 
 MID_PLAYTIME Mid_PlayTime;
 
+void (*Mid_ProcObserver)(
+	MID_PULSE pulse, uint8_t status, std::span<const uint8_t> data
+) = nullptr;
+
 
 MID_FLAGS Mid_SetFlags(MID_FLAGS flags_new)
 {
@@ -401,6 +494,7 @@ bool Mid_Load(BYTE_BUFFER_OWNED buffer)
 		track.data = maybe_data.value();
 	}
 
+	Mid_Seq.timeline.Build(Mid_Seq.tracks, Mid_Seq.tempo.ppqn);
 	Mid_Seq.Rewind();
 	return true;
 }
@@ -634,6 +728,13 @@ void Mid_Proc(MID_REALTIME delta)
 					pulse_sync = p.next_pulse;
 					time.realtime_since_last_event = -p.next_time;
 				}
+				if(Mid_ProcObserver) {
+					const auto status = ((event.kind == MID_EVENT_KIND::META)
+						? event.meta
+						: event.status
+					);
+					Mid_ProcObserver(p.next_pulse, status, event.extra_data);
+				}
 				Mid_Seq.Process(p, event);
 				if(Mid_Dev.state == MID_BACKEND_STATE::PLAY) {
 					event.Send();
@@ -753,6 +854,18 @@ void MID_EVENT::Send(void) const
 #endif
 }
 
+// Parses the quarter note duration from a Set Tempo meta event.
+static MID_REALTIME QNDurationFrom(const MID_EVENT& event)
+{
+	uint32_t tempo_new = 0;
+	for(const auto byte : event.extra_data) {
+		tempo_new = ((tempo_new << 8) + byte);
+	}
+	return std::chrono::duration_cast<MID_REALTIME>(
+		std::chrono::microseconds{ tempo_new }
+	);
+}
+
 void MID_SEQUENCE::Process(MID_TRACK& track, const MID_EVENT& event)
 {
 	switch(event.kind) {
@@ -768,13 +881,7 @@ void MID_SEQUENCE::Process(MID_TRACK& track, const MID_EVENT& event)
 			return;
 
 		case 0x51: { // テンポ
-			uint32_t tempo_new = 0;
-			for(const auto byte : event.extra_data) {
-				tempo_new = ((tempo_new << 8) + byte);
-			}
-			tempo.qn_duration = std::chrono::duration_cast<MID_REALTIME>(
-				std::chrono::microseconds{ tempo_new }
-			);
+			tempo.qn_duration = QNDurationFrom(event);
 
 			// Recalculate the next tick on all tracks, preserving the amount
 			// of time we've overshot when reaching this one.
@@ -854,6 +961,376 @@ void MID_SEQUENCE::Process(MID_TRACK& track, const MID_EVENT& event)
 	track.ConsumeDelta(tempo, loop);
 }
 
+// Seeking
+// -------
+
+void MID_CHANNEL_STATE::Apply(const MID_EVENT& event)
+{
+	switch(event.kind) {
+	case MID_EVENT_KIND::CONTROLLER: {
+		const auto cc = event.extra_data[0];
+		const auto value = event.extra_data[1];
+		switch(cc) {
+		case 0x06: // Data Entry MSB
+			if((rpn_msb == 0x00) && (rpn_lsb < MIDI_RPNS_TRACKED)) {
+				rpn_data[rpn_lsb] = value;
+			}
+			break;
+		case 0x62: // NRPN LSB
+		case 0x63: // NRPN MSB
+			rpn_msb = UNSET;
+			rpn_lsb = UNSET;
+			break;
+		case 0x64: // RPN LSB
+			rpn_lsb = value;
+			break;
+		case 0x65: // RPN MSB
+			rpn_msb = value;
+			break;
+		case 0x79: // Reset All Controllers
+			// GM's Recommended Practice RP-015 keeps bank select, volume, pan,
+			// and the effect depths.
+			for(uint8_t i = 0; i < controllers.size(); i++) {
+				if(
+					(i != 0x00) && (i != 0x07) && (i != 0x0a) && (i != 0x20) &&
+					((i < 0x5b) || (i > 0x5f))
+				) {
+					controllers[i] = UNSET;
+				}
+			}
+			rpn_msb = UNSET;
+			rpn_lsb = UNSET;
+			bend_lsb = UNSET;
+			bend_msb = UNSET;
+			break;
+		default:
+			// Channel Mode messages don't carry state we could restore.
+			if(cc < 0x78) {
+				controllers[cc] = value;
+			}
+			break;
+		}
+		break;
+	}
+	case MID_EVENT_KIND::PROGRAM_CHANGE:
+		program = event.extra_data[0];
+		break;
+	case MID_EVENT_KIND::PITCH_BEND:
+		bend_lsb = event.extra_data[0];
+		bend_msb = event.extra_data[1];
+		break;
+	default:
+		break;
+	}
+}
+
+void MID_CHANNEL_STATE::Send(uint8_t ch, VOLUME volume) const
+{
+#ifdef SUPPORT_MIDI_BACKEND
+	const uint8_t status = (0xb0 + ch);
+	MidBackend_Out(status, 0x7b, 0x00); // オール・ノート・オフ
+	MidBackend_Out(status, 0x79, 0x00); // Reset All Controllers
+
+	// Data Entry and (N)RPN selection only make sense in the order they
+	// appeared in, so we send the tracked RPNs separately below. Volume and
+	// pan are not covered by Reset All Controllers and must always be sent.
+	for(uint8_t cc = 0; cc < controllers.size(); cc++) {
+		const auto value = controllers[cc];
+		if(
+			(value == UNSET) || (cc == 0x06) || (cc == 0x07) || (cc == 0x26) ||
+			((cc >= 0x60) && (cc <= 0x65))
+		) {
+			continue;
+		}
+		MidBackend_Out(status, cc, value);
+	}
+	if(controllers[0x0a] == UNSET) {
+		MidBackend_Out(status, 0x0a, 0x40);
+	}
+	for(uint8_t rpn = 0; rpn < MIDI_RPNS_TRACKED; rpn++) {
+		if(rpn_data[rpn] == UNSET) {
+			continue;
+		}
+		MidBackend_Out(status, 0x65, 0x00);
+		MidBackend_Out(status, 0x64, rpn);
+		MidBackend_Out(status, 0x06, rpn_data[rpn]);
+	}
+	MidBackend_Out(status, 0x65, 0x7f); // RPN Null
+	MidBackend_Out(status, 0x64, 0x7f);
+
+	if(program != UNSET) {
+		MidBackend_Out((0xc0 + ch), program);
+	}
+	if(bend_msb != UNSET) {
+		MidBackend_Out((0xe0 + ch), bend_lsb, bend_msb);
+	}
+	MidBackend_Out(status, 0x07, volume);
+#endif
+}
+
+void MID_TIMELINE::Build(std::span<const MID_TRACK> tracks, uint16_t ppqn_new)
+{
+	ppqn = ppqn_new;
+	for(size_t t = 0; t < tracks.size(); t++) {
+		MID_TRACK_ITERATOR it = { tracks[t].data };
+		MID_PULSE pulse = 0;
+		while(true) {
+			const auto delta = it.ConsumeVLQ();
+			if(delta == -1) {
+				break;
+			}
+			pulse += delta;
+			const auto it_event = it;
+			const auto maybe_event = it.ConsumeEvent();
+			if(!maybe_event) {
+				break;
+			}
+			const auto& event = maybe_event.value();
+			events.emplace_back(MID_TIMELINE_EVENT{
+				.pulse = pulse, .track = t, .it = it_event, .event = event,
+			});
+			if((event.kind == MID_EVENT_KIND::META) && (event.meta == 0x2f)) {
+				break;
+			}
+		}
+	}
+
+	// Since we added the events track by track, a stable sort gives us the
+	// same order in which Mid_Proc() processes simultaneous events.
+	std::ranges::stable_sort(events, {}, &MID_TIMELINE_EVENT::pulse);
+
+	MID_TEMPO tempo = { .qn_duration = QN_DURATION_DEFAULT, .ppqn = ppqn };
+	MID_CHANNEL_STATES channels;
+	MID_REALTIME time = 0s;
+	MID_PULSE pulse_prev = 0;
+	track_events.resize(tracks.size());
+	snapshots.reserve(
+		(events.size() + SNAPSHOT_INTERVAL - 1) / SNAPSHOT_INTERVAL
+	);
+	for(size_t i = 0; i < events.size(); i++) {
+		auto& ev = events[i];
+		if((i % SNAPSHOT_INTERVAL) == 0) {
+			snapshots.emplace_back(i, channels);
+		}
+		time += tempo.RealtimeFromDelta(ev.pulse - pulse_prev);
+		pulse_prev = ev.pulse;
+		ev.time = time;
+
+		const auto& event = ev.event;
+		if(event.kind == MID_EVENT_KIND::META) {
+			if(event.meta == 0x51) {
+				tempo.qn_duration = QNDurationFrom(event);
+			}
+		} else if(event.kind < MID_EVENT_KIND::SYSEX) {
+			channels[event.Channel()].Apply(event);
+		}
+		ev.qn_duration = tempo.qn_duration;
+		track_events[ev.track].emplace_back(i);
+	}
+}
+
+size_t MID_TIMELINE::FirstEventAt(MID_PULSE pulse) const
+{
+	const auto it = std::ranges::lower_bound(
+		events, pulse, {}, &MID_TIMELINE_EVENT::pulse
+	);
+	return (it - events.begin());
+}
+
+MID_TEMPO MID_TIMELINE::TempoBefore(size_t i) const
+{
+	const auto qn_duration = ((i > 0)
+		? events[i - 1].qn_duration
+		: QN_DURATION_DEFAULT
+	);
+	return MID_TEMPO{ .qn_duration = qn_duration, .ppqn = ppqn };
+}
+
+MID_REALTIME MID_TIMELINE::RealtimeAt(MID_PULSE pulse) const
+{
+	const auto i = FirstEventAt(pulse);
+	const auto tempo = TempoBefore(i);
+	if(i == 0) {
+		return tempo.RealtimeFromDelta(pulse);
+	}
+	const auto& prev = events[i - 1];
+	return (prev.time + tempo.RealtimeFromDelta(pulse - prev.pulse));
+}
+
+MID_PULSE MID_TIMELINE::PulseAt(MID_REALTIME realtime) const
+{
+	const auto it = std::ranges::lower_bound(
+		events, realtime, {}, &MID_TIMELINE_EVENT::time
+	);
+	const auto i = (it - events.begin());
+	const auto tempo = TempoBefore(i);
+	if(i == 0) {
+		return tempo.DeltaFromRealtime(realtime);
+	}
+	const auto& prev = events[i - 1];
+	return (prev.pulse + tempo.DeltaFromRealtime(realtime - prev.time));
+}
+
+void MID_SEQUENCE::Seek(MID_PULSE target)
+{
+	const auto& events = timeline.events;
+	if(events.empty()) {
+		return;
+	}
+	target = (std::max)(target, MID_PULSE{ 0 });
+	if(loop && (target >= loop.end)) {
+		const auto loop_length = (loop.end - loop.start);
+		target = (loop.start + ((target - loop.start) % loop_length));
+	}
+	target = (std::min)(target, events.back().pulse);
+	const auto first = timeline.FirstEventAt(target);
+
+	// Channel state and tempo
+	// -----------------------
+	// Replay all events between the closest snapshot and [target].
+
+	const auto& snapshot = timeline.snapshots[
+		first / MID_TIMELINE::SNAPSHOT_INTERVAL
+	];
+	auto channels = snapshot.channels;
+	for(auto i = snapshot.event_index; i < first; i++) {
+		const auto& event = events[i].event;
+		if(event.kind < MID_EVENT_KIND::SYSEX) {
+			channels[event.Channel()].Apply(event);
+		}
+	}
+	tempo = timeline.TempoBefore(first);
+
+	Mid_TableInit();
+	for(auto ch = decltype(MIDI_CHANNELS){0}; ch < MIDI_CHANNELS; ch++) {
+		const auto& state = channels[ch];
+		const auto restore = [&](uint8_t (&table)[16], uint8_t cc) {
+			if(state.controllers[cc] != MID_CHANNEL_STATE::UNSET) {
+				table[ch] = state.controllers[cc];
+			}
+		};
+		restore(Mid_VolumeTable, 0x07);
+		restore(Mid_PanpodTable, 0x0a);
+		restore(Mid_ExpressionTable, 0x0b);
+		if(Mid_Dev.state != MID_BACKEND_STATE::STOP) {
+			// Paused channels are muted, see Mid_Pause().
+			const auto volume = ((Mid_Dev.state == MID_BACKEND_STATE::PLAY)
+				? Mid_Dev.VolumeFor(ch)
+				: 0
+			);
+			state.Send(ch, volume);
+		}
+	}
+	// -----------------------
+
+	// Track positions
+	// ---------------
+
+	const auto pulse_of = [&events](size_t i) {
+		return events[i].pulse;
+	};
+	for(size_t t = 0; t < tracks.size(); t++) {
+		auto& track = tracks[t];
+		const auto& indices = timeline.track_events[t];
+		const auto next = std::ranges::lower_bound(
+			indices, target, {}, pulse_of
+		);
+
+		// Replicate what ConsumeDelta() would have done on the way here.
+		track.loop_it = {};
+		track.loop_pulse = 0;
+		if(loop) {
+			const auto loop_first = std::ranges::lower_bound(
+				indices, loop.start, {}, pulse_of
+			);
+			if(
+				(loop_first != indices.end()) &&
+				(loop_first <= next) &&
+				(events[*loop_first].pulse < loop.end)
+			) {
+				track.loop_it = events[*loop_first].it;
+				track.loop_pulse = events[*loop_first].pulse;
+			}
+		}
+
+		track.play = true;
+		track.next_time = 0s;
+		track.prev_pulse = ((next != indices.begin())
+			? events[*std::prev(next)].pulse
+			: 0
+		);
+		if(
+			(next == indices.end()) ||
+			(loop && (events[*next].pulse > loop.end))
+		) {
+			// The track either ended before [target], or its next event lies
+			// after the loop end point.
+			if(track.loop_it) {
+				TrackLoop(track, tempo, loop, target);
+			} else {
+				track.play = false;
+			}
+			continue;
+		}
+		const auto& ev = events[*next];
+		if(loop && !track.loop_it && (ev.pulse >= loop.end)) {
+			track.play = false;
+			continue;
+		}
+		track.it = ev.it;
+		track.next_pulse = ev.pulse;
+		track.next_delta = (ev.pulse - track.prev_pulse);
+		track.next_time = tempo.RealtimeFromDelta(ev.pulse - target);
+	}
+	// ---------------
+
+	Mid_PlayTime = {
+		.pulse_of_last_event_processed = target,
+		.pulse_interpolated = target,
+		.realtime = std::chrono::round<decltype(Mid_PlayTime.realtime)>(
+			timeline.RealtimeAt(target)
+		),
+	};
+}
+
+// The backend timer might call Mid_Proc() from another thread, so we must
+// stop it while seeking.
+static void SeekWithTimerStopped(MID_PULSE pulse)
+{
+#ifdef SUPPORT_MIDI_BACKEND
+	const auto playing = (Mid_Dev.state == MID_BACKEND_STATE::PLAY);
+	if(playing) {
+		MidBackend_StopTimer();
+	}
+	Mid_Seq.Seek(pulse);
+	if(playing) {
+		MidBackend_StartTimer();
+	}
+#else
+	Mid_Seq.Seek(pulse);
+#endif
+}
+
+void Mid_Seek(MID_PULSE pulse)
+{
+	if(!Mid_Loaded()) {
+		return;
+	}
+	SeekWithTimerStopped(pulse);
+}
+
+void Mid_SeekBy(MID_REALTIME delta)
+{
+	if(!Mid_Loaded()) {
+		return;
+	}
+	const auto& timeline = Mid_Seq.timeline;
+	const auto now = timeline.RealtimeAt(Mid_PlayTime.pulse_interpolated);
+	const auto then = (std::max)((now + delta), MID_REALTIME::zero());
+	SeekWithTimerStopped(timeline.PulseAt(then));
+}
+// -------
+
 Any::string_view Mid_GetTitle(void)
 {
 	std::optional<MID_EVENT> maybe_ev;
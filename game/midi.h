@@ -102,6 +102,24 @@ Any::string_view Mid_GetTitle(void);	// この曲のお名前は？
 // sequence.
 void Mid_Proc(MID_REALTIME delta);
 
+// Called by Mid_Proc() for every event it processes, in order and whether or
+// not a backend is playing, with the event's pulse, raw status byte, and data
+// bytes. Meta events pass their type (always < 0x80) as [status]. Allows
+// tests to compare the events played after a seek with linear playback.
+extern void (*Mid_ProcObserver)(
+	MID_PULSE pulse, uint8_t status, std::span<const uint8_t> data
+);
+
+// Jumps to the given [pulse] of the currently loaded sequence, restoring the
+// tempo and all channel controller, program, and pitch bend state that would
+// have been active at that point. Positions past the loop end point wrap
+// around to the loop start.
+void Mid_Seek(MID_PULSE pulse);
+
+// Seeks by the given realtime [delta] relative to the current position,
+// measured at the sequence's own tempo.
+void Mid_SeekBy(MID_REALTIME delta);
+
 void Mid_TableInit(void);					// 各種テーブルの初期化
 
 
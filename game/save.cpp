@@ -0,0 +1,83 @@
+/*
+ *   Background saving
+ *
+ */
+
+#include "game/save.h"
+#include "platform/thread.h"
+
+static struct {
+	std::deque<std::move_only_function<bool(void)>> queue;
+	bool busy = false;
+	bool closing = false;
+	bool failed = false;
+	std::mutex mutex;
+	std::condition_variable cv;
+	THREAD worker;
+} SaveThread;
+
+static void SaveWorker(const THREAD_STOP&)
+{
+	auto& st = SaveThread;
+	while(true) {
+		std::unique_lock lock{ st.mutex };
+		st.cv.wait(lock, [&] {
+			return (st.closing || !st.queue.empty());
+		});
+		if(st.queue.empty()) {
+			return;
+		}
+		auto func = std::move(st.queue.front());
+		st.queue.pop_front();
+		st.busy = true;
+		lock.unlock();
+
+		const auto ret = func();
+
+		lock.lock();
+		st.failed |= !ret;
+		st.busy = false;
+		st.cv.notify_all();
+	}
+}
+
+void Save_Queue(std::move_only_function<bool(void)> func)
+{
+	auto& st = SaveThread;
+	{
+		std::lock_guard lock{ st.mutex };
+		if(!st.worker.Joinable()) {
+			st.closing = false;
+			st.worker = ThreadStart(SaveWorker);
+		}
+		if(st.worker.Joinable()) {
+			st.queue.emplace_back(std::move(func));
+			st.cv.notify_all();
+			return;
+		}
+	}
+	const auto ret = func();
+	std::lock_guard lock{ st.mutex };
+	st.failed |= !ret;
+}
+
+bool Save_Wait(void)
+{
+	auto& st = SaveThread;
+	std::unique_lock lock{ st.mutex };
+	st.cv.wait(lock, [&] {
+		return (st.queue.empty() && !st.busy);
+	});
+	return !std::exchange(st.failed, false);
+}
+
+void Save_Flush(void)
+{
+	auto& st = SaveThread;
+	{
+		std::lock_guard lock{ st.mutex };
+		st.closing = true;
+	}
+	st.cv.notify_all();
+	st.worker.Join();
+}
@@ -0,0 +1,26 @@
+/*
+ *   Background saving
+ *
+ */
+
+#pragma once
+
+import std.compat;
+
+// Saves run on a single background thread, in the order they were queued, so
+// that compressing and writing files never stalls the game. Each save should
+// write its file via File_Replace() or PACKFILE_WRITE, which never leave a
+// partially written file behind.
+
+// Queues [func] to run on the save thread. [func] must own copies of all data
+// it writes, since the game keeps modifying its state in the meantime. If the
+// thread can't be started, [func] runs immediately.
+void Save_Queue(std::move_only_function<bool(void)> func);
+
+// Waits for all queued saves to be written. Must be called before reading any
+// file that might still be queued. Returns `false` if any save failed since
+// the last call.
+bool Save_Wait(void);
+
+// Waits for all queued saves to be written and stops the save thread.
+void Save_Flush(void);
@@ -0,0 +1,106 @@
+/*
+ *   Simulation state snapshots
+ *
+ */
+
+#include <assert.h>
+
+#include "game/snapshot.h"
+
+// Function-local to sidestep the static initialization order of the
+// SNAPSHOT_STATE objects in other translation units.
+static std::vector<std::span<std::byte>>& Regions(void)
+{
+	static std::vector<std::span<std::byte>> ret;
+	return ret;
+}
+
+static auto& RegionsDynamic(void)
+{
+	static std::vector<std::function<std::span<std::byte>(void)>> ret;
+	return ret;
+}
+
+void SNAPSHOT_STATE::Register(std::span<std::byte> region)
+{
+	Regions().emplace_back(region);
+}
+
+void SNAPSHOT_STATE::Register(
+	std::function<std::span<std::byte>(void)> region
+)
+{
+	RegionsDynamic().emplace_back(std::move(region));
+}
+
+// Calls [func] for every registered region, with the static ones first.
+static void ForEachRegion(auto&& func)
+{
+	for(const auto& region : Regions()) {
+		func(region);
+	}
+	for(const auto& region : RegionsDynamic()) {
+		func(region());
+	}
+}
+
+void Snapshot_Save(BYTE_BUFFER_GROWABLE& buf)
+{
+	size_t size = 0;
+	ForEachRegion([&](std::span<std::byte> region) {
+		size += region.size();
+	});
+	buf.resize(size);
+
+	auto* p = reinterpret_cast<std::byte *>(buf.data());
+	ForEachRegion([&](std::span<std::byte> region) {
+		p = std::ranges::copy(region, p).out;
+	});
+}
+
+void Snapshot_Restore(const BYTE_BUFFER_GROWABLE& buf)
+{
+	auto* p = reinterpret_cast<const std::byte *>(buf.data());
+	ForEachRegion([&](std::span<std::byte> region) {
+		std::ranges::copy_n(p, region.size(), region.begin());
+		p += region.size();
+	});
+}
+
+// State hashes
+// ------------
+
+static std::vector<std::u8string_view>& HashNames(void)
+{
+	static std::vector<std::u8string_view> ret;
+	return ret;
+}
+
+static std::vector<void (*)(STATE_HASH& h)>& HashFuncs(void)
+{
+	static std::vector<void (*)(STATE_HASH& h)> ret;
+	return ret;
+}
+
+SNAPSHOT_HASH::SNAPSHOT_HASH(const char8_t *name, void (*func)(STATE_HASH& h))
+{
+	HashNames().emplace_back(name);
+	HashFuncs().emplace_back(func);
+}
+
+std::span<const std::u8string_view> Snapshot_HashNames(void)
+{
+	return HashNames();
+}
+
+void Snapshot_Hash(std::span<uint32_t> out)
+{
+	const auto& funcs = HashFuncs();
+	assert(out.size() == funcs.size());
+	for(size_t i = 0; i < funcs.size(); i++) {
+		STATE_HASH h;
+		funcs[i](h);
+		out[i] = h.v;
+	}
+}
+// ------------
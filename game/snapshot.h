@@ -0,0 +1,92 @@
+/*
+ *   Simulation state snapshots
+ *
+ */
+
+#pragma once
+
+#include "platform/buffer.h"
+
+// Contiguous heap storage of trivially copyable elements, whose location and
+// size are only known at runtime.
+template <class T> concept SNAPSHOT_DYNAMIC = (
+	!std::is_trivially_copyable_v<T> &&
+	std::ranges::contiguous_range<T> &&
+	std::is_trivially_copyable_v<std::ranges::range_value_t<T>>
+);
+
+// Declares a set of trivially copyable variables as part of the deterministic
+// simulation state, which can then be saved and restored as a whole using the
+// functions below. Define one of these as a static object directly below the
+// definitions of the covered variables, so that new state doesn't get
+// forgotten.
+class SNAPSHOT_STATE {
+	static void Register(std::span<std::byte> region);
+	static void Register(std::function<std::span<std::byte>(void)> region);
+
+	template <class T> static void RegisterObj(T& obj) {
+		if constexpr(SNAPSHOT_DYNAMIC<T>) {
+			Register([&obj] {
+				return std::as_writable_bytes(std::span{ obj });
+			});
+		} else {
+			Register(std::as_writable_bytes(std::span{ &obj, 1 }));
+		}
+	}
+
+public:
+	template <class... T> requires (
+		(std::is_trivially_copyable_v<T> || SNAPSHOT_DYNAMIC<T>) && ...
+	)
+	SNAPSHOT_STATE(T&... objs) {
+		(RegisterObj(objs), ...);
+	}
+};
+
+// Copies all registered state into [buf], reusing its allocation.
+void Snapshot_Save(BYTE_BUFFER_GROWABLE& buf);
+
+// Overwrites all registered state with the contents of [buf], which must have
+// been filled by Snapshot_Save().
+void Snapshot_Restore(const BYTE_BUFFER_GROWABLE& buf);
+
+// State hashes
+// ------------
+// Snapshots contain pointers and padding bytes, which differ between
+// processes. To detect desyncs, each subsystem instead hashes the integer
+// values that define its state.
+
+// 32-bit FNV-1a over the little-endian 64-bit representation of each value,
+// which keeps the result independent of the platform and the exact types.
+// Don't add plain `char` values, whose signedness differs between platforms.
+struct STATE_HASH {
+	uint32_t v = 0x811C9DC5;
+
+	void Add(std::integral auto... vals) {
+		(AddU64(static_cast<uint64_t>(vals)), ...);
+	}
+
+private:
+	void AddU64(uint64_t val) {
+		for(int i = 0; i < 8; i++) {
+			v = ((v ^ static_cast<uint32_t>(val & 0xFF)) * 0x01000193u);
+			val >>= 8;
+		}
+	}
+};
+
+// Declares a named subsystem that contributes to the state hash. Define one
+// of these as a static object next to the subsystem's SNAPSHOT_STATE.
+class SNAPSHOT_HASH {
+public:
+	SNAPSHOT_HASH(const char8_t *name, void (*func)(STATE_HASH& h));
+};
+
+// Returns the names of all registered subsystems. The order is arbitrary, but
+// fixed for the lifetime of the process.
+std::span<const std::u8string_view> Snapshot_HashNames(void);
+
+// Writes the current hash of each subsystem into [out], in the order of
+// Snapshot_HashNames().
+void Snapshot_Hash(std::span<uint32_t> out);
+// ------------
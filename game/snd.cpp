@@ -12,6 +12,8 @@
 #include <assert.h>
 
 float Snd_BGMGainFactor = 1.0f;
+bool Snd_SEMuted = false;
+bool Snd_Offline = false;
 
 static enum class SND_SYS {
 	_HAS_BITFLAG_OPERATORS,
@@ -119,11 +121,17 @@ bool Snd_SELoad(BYTE_BUFFER_OWNED buffer, uint8_t id, SND_INSTANCE_ID max)
 
 void Snd_SEPlay(uint8_t id, int x, bool loop)
 {
+	if(Snd_SEMuted) {
+		return;
+	}
 	return SndBackend_SEPlay(id, x, loop);
 }
 
 void Snd_SEStop(uint8_t id)
 {
+	if(Snd_SEMuted) {
+		return;
+	}
 	return SndBackend_SEStop(id);
 }
 
@@ -133,3 +141,21 @@ void Snd_SEStopAll(void)
 		SndBackend_SEStop(i);
 	}
 }
+
+std::optional<SND_OFFLINE_FORMAT> Snd_OfflineStart(void)
+{
+	if(!(Initialized & SND_SYS::SYSTEM)) {
+		return std::nullopt;
+	}
+	return SndBackend_OfflineStart();
+}
+
+void Snd_OfflineRender(std::span<float> out)
+{
+	SndBackend_OfflineRender(out);
+}
+
+void Snd_OfflineEnd(void)
+{
+	SndBackend_OfflineEnd();
+}
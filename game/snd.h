@@ -40,7 +40,38 @@ void Snd_SECleanup(void);
 
 bool Snd_SELoad(BYTE_BUFFER_OWNED buffer, uint8_t id, SND_INSTANCE_ID max);
 
+// Suppresses all sound effect playback and stop requests while `true`.
+extern bool Snd_SEMuted;
+
 // 再生＆停止 //
 void Snd_SEPlay(uint8_t id, int x = SND_X_MID, bool loop = false);
 void Snd_SEStop(uint8_t id);
 void Snd_SEStopAll(void);
+
+// Offline rendering
+// -----------------
+// Detaches mixing from the audio device, allowing the game to pull the mixed
+// output at its own pace. Only covers sound that goes through the PCM
+// backend, i.e., sound effects and waveform BGM, but not MIDI.
+
+// Set before the sound system is initialized to never open an audio device.
+// Sound is then only mixed via Snd_OfflineRender().
+extern bool Snd_Offline;
+
+struct SND_OFFLINE_FORMAT {
+	uint32_t rate;
+	uint16_t channels;
+};
+
+// Stops mixing to the audio device and returns the format of the samples
+// returned by Snd_OfflineRender(), or `std::nullopt` if the sound system isn't
+// running or the backend doesn't support offline rendering.
+std::optional<SND_OFFLINE_FORMAT> Snd_OfflineStart(void);
+
+// Mixes the next (out.size() / channels) interleaved 32-bit float sample
+// frames into [out].
+void Snd_OfflineRender(std::span<float> out);
+
+// Resumes mixing to the audio device.
+void Snd_OfflineEnd(void);
+// -----------------
@@ -0,0 +1,208 @@
+/*
+ *   Spectrum analyzer for waveform BGM
+ *
+ */
+
+#include "game/spectrum.h"
+
+using COMPLEX = std::complex<float>;
+
+static constexpr float FREQ_LOW = 50.0f;
+static constexpr float FREQ_HIGH = 16000.0f;
+
+// Levels at or below this value are displayed as 0.
+static constexpr float DB_FLOOR = -60.0f;
+
+// Tap
+// ---
+// Single-producer, single-consumer ring of downmixed mono samples. The reader
+// only ever needs the most recent window, so the writer never waits and just
+// overwrites the oldest samples.
+
+static constexpr size_t RING_SIZE = (SPECTRUM_FFT_SIZE * 2);
+
+static std::atomic<bool> Active = false;
+static std::array<std::atomic<float>, RING_SIZE> Ring;
+static std::atomic<size_t> RingWritten = 0;
+static std::atomic<uint32_t> RingSamplingRate = 0;
+
+void Spectrum_SetActive(bool active)
+{
+	if(active) {
+		RingWritten.store(0, std::memory_order_relaxed);
+	}
+	Active.store(active, std::memory_order_release);
+}
+
+template <class T> static float SampleAt(const std::byte *p)
+{
+	T ret;
+	memcpy(&ret, p, sizeof(T));
+	return (ret / (static_cast<float>((std::numeric_limits<T>::max)()) + 1));
+}
+
+void Spectrum_Feed(std::span<const std::byte> pcm, const PCM_FORMAT& pcmf)
+{
+	if(!Active.load(std::memory_order_acquire)) {
+		return;
+	}
+	const auto byte_depth = std::to_underlying(pcmf.format);
+	const auto frame_size = pcmf.SampleSize();
+	const auto frames = (pcm.size() / frame_size);
+	auto written = RingWritten.load(std::memory_order_relaxed);
+	for(size_t f = 0; f < frames; f++) {
+		const auto* p = &pcm[f * frame_size];
+		float sum = 0.0f;
+		for(uint16_t c = 0; c < pcmf.channels; c++) {
+			switch(pcmf.format) {
+			case PCM_SAMPLE_FORMAT::S16: sum += SampleAt<int16_t>(p); break;
+			case PCM_SAMPLE_FORMAT::S32: sum += SampleAt<int32_t>(p); break;
+			}
+			p += byte_depth;
+		}
+		Ring[written % RING_SIZE].store(
+			(sum / pcmf.channels), std::memory_order_relaxed
+		);
+		written++;
+	}
+	RingSamplingRate.store(pcmf.samplingrate, std::memory_order_relaxed);
+	RingWritten.store(written, std::memory_order_release);
+}
+// ---
+
+// Analysis
+// --------
+
+// In-place iterative radix-2 FFT. [v.size()] must be a power of two.
+static void FFT(std::span<COMPLEX> v)
+{
+	const auto n = v.size();
+	for(size_t i = 1, j = 0; i < n; i++) {
+		auto bit = (n >> 1);
+		for(; (j & bit); bit >>= 1) {
+			j ^= bit;
+		}
+		j ^= bit;
+		if(i < j) {
+			std::swap(v[i], v[j]);
+		}
+	}
+	for(size_t len = 2; len <= n; len <<= 1) {
+		const auto angle = ((-2.0f * std::numbers::pi_v<float>) / len);
+		const auto w_len = std::polar(1.0f, angle);
+		for(size_t i = 0; i < n; i += len) {
+			COMPLEX w = 1.0f;
+			for(size_t j = 0; j < (len / 2); j++) {
+				const auto u = v[i + j];
+				const auto t = (v[i + j + (len / 2)] * w);
+				v[i + j] = (u + t);
+				v[i + j + (len / 2)] = (u - t);
+				w *= w_len;
+			}
+		}
+	}
+}
+
+void Spectrum_Analyze(
+	std::span<float, SPECTRUM_FFT_SIZE> samples,
+	uint32_t samplingrate,
+	std::span<float> bands
+)
+{
+	constexpr auto N = SPECTRUM_FFT_SIZE;
+	constexpr auto HALF = (N / 2);
+	constexpr auto TAU = (2.0f * std::numbers::pi_v<float>);
+	static const auto WINDOW = [] {
+		std::array<float, N> ret;
+		for(size_t i = 0; i < N; i++) {
+			const auto phase = ((TAU * i) / (N - 1));
+			ret[i] = (0.5f * (1.0f - std::cos(phase)));
+		}
+		return ret;
+	}();
+
+	for(size_t i = 0; i < N; i++) {
+		samples[i] *= WINDOW[i];
+	}
+
+	// Real FFT via a complex FFT of half the size, with the even samples in
+	// the real and the odd samples in the imaginary part.
+	std::array<COMPLEX, HALF> z;
+	for(size_t k = 0; k < HALF; k++) {
+		z[k] = { samples[2 * k], samples[(2 * k) + 1] };
+	}
+	FFT(z);
+
+	// A full-scale sine wave peaks at (N / 2) × the window's mean of 0.5.
+	constexpr float SCALE = (4.0f / N);
+	std::array<float, HALF> magnitudes;
+	for(size_t k = 0; k < HALF; k++) {
+		const auto zc = std::conj(z[(HALF - k) % HALF]);
+		const auto even = ((z[k] + zc) * 0.5f);
+		const auto odd = ((z[k] - zc) * COMPLEX{ 0.0f, -0.5f });
+		const auto twiddle = std::polar(1.0f, ((-TAU * k) / N));
+		magnitudes[k] = (std::abs(even + (twiddle * odd)) * SCALE);
+	}
+
+	// Logarithmic binning, using the loudest FFT bin within each band.
+	const auto bin_width = (static_cast<float>(samplingrate) / N);
+	const auto ratio = std::pow(
+		(FREQ_HIGH / FREQ_LOW), (1.0f / static_cast<float>(bands.size()))
+	);
+	auto freq = FREQ_LOW;
+	for(auto& band : bands) {
+		const auto k_first = static_cast<size_t>(freq / bin_width);
+		freq *= ratio;
+		const auto k_last = (std::max)(
+			k_first, static_cast<size_t>(freq / bin_width)
+		);
+		float peak = 0.0f;
+		for(auto k = k_first; (k <= k_last) && (k < HALF); k++) {
+			peak = (std::max)(peak, magnitudes[k]);
+		}
+		band = (20.0f * std::log10((std::max)(peak, 1e-6f)));
+	}
+}
+
+void Spectrum_Update(std::span<uint16_t> levels)
+{
+	static size_t last_written = 0;
+	static std::vector<float> bands;
+
+	// Same decay as the MIDI-based spectrum.
+	for(auto& level : levels) {
+		if(level != 0) {
+			level -= ((level >> 3) + 1);
+		}
+	}
+
+	const auto written = RingWritten.load(std::memory_order_acquire);
+	if((written == last_written) || (written < SPECTRUM_FFT_SIZE)) {
+		last_written = written;
+		return;
+	}
+	last_written = written;
+
+	std::array<float, SPECTRUM_FFT_SIZE> samples;
+	const auto start = (written - SPECTRUM_FFT_SIZE);
+	for(size_t i = 0; i < samples.size(); i++) {
+		samples[i] = Ring[(start + i) % RING_SIZE].load(
+			std::memory_order_relaxed
+		);
+	}
+	const auto samplingrate = RingSamplingRate.load(std::memory_order_relaxed);
+	if(samplingrate == 0) {
+		return;
+	}
+	bands.resize(levels.size());
+	Spectrum_Analyze(samples, samplingrate, bands);
+
+	for(size_t i = 0; i < levels.size(); i++) {
+		const auto db = std::clamp(bands[i], DB_FLOOR, 0.0f);
+		const auto level = static_cast<uint16_t>(
+			((db - DB_FLOOR) * SPECTRUM_LEVEL_MAX) / -DB_FLOOR
+		);
+		levels[i] = (std::max)(levels[i], level);
+	}
+}
+// --------
@@ -0,0 +1,37 @@
+/*
+ *   Spectrum analyzer for waveform BGM
+ *
+ */
+
+#pragma once
+
+#include "game/pcm.h"
+
+// Number of samples that make up one analysis window.
+constexpr size_t SPECTRUM_FFT_SIZE = 2048;
+
+// Highest value returned by Spectrum_Update().
+constexpr uint16_t SPECTRUM_LEVEL_MAX = 64;
+
+// Enables or disables the tap on the BGM output. While inactive,
+// Spectrum_Feed() returns immediately.
+void Spectrum_SetActive(bool active);
+
+// Feeds decoded BGM samples in the given format into the analyzer. Called from
+// the audio thread, and lock-free.
+void Spectrum_Feed(std::span<const std::byte> pcm, const PCM_FORMAT& pcmf);
+
+// Analyzes the given window of mono [samples] at the given sampling rate, and
+// writes the level of each logarithmically spaced frequency band between
+// 50 Hz and 16 kHz to [bands], in decibels relative to a full-scale sine wave.
+// [samples] is windowed in place. Independent of any global state.
+void Spectrum_Analyze(
+	std::span<float, SPECTRUM_FFT_SIZE> samples,
+	uint32_t samplingrate,
+	std::span<float> bands
+);
+
+// Analyzes the most recently fed samples and updates [levels] in place, with
+// peak decay applied to the previous values. Levels range from 0 to
+// SPECTRUM_LEVEL_MAX.
+void Spectrum_Update(std::span<uint16_t> levels);
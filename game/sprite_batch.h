@@ -0,0 +1,39 @@
+/*
+ *   Per-frame sprite batches
+ *
+ */
+
+#pragma once
+
+#include "platform/graphics_backend.h"
+
+// Collects the blits of a single surface over the course of a frame, and
+// submits them in order via GrpSurface_BlitBatch(). Keeps its allocation
+// across frames when used as a static object.
+class SPRITE_BATCH {
+	std::vector<GRP_SPRITE> sprites;
+
+public:
+	// Blits every sprite right away with GrpSurface_Blit() instead, like the
+	// original game did. Only meant for comparisons in benchmarks.
+	static inline bool Unbatched = false;
+
+	const SURFACE_ID sid;
+
+	SPRITE_BATCH(SURFACE_ID sid) : sid(sid) {
+	}
+
+	void Blit(WINDOW_POINT topleft, const PIXEL_LTRB& src) {
+		if(Unbatched) {
+			GrpSurface_Blit(topleft, sid, src);
+			return;
+		}
+		sprites.push_back({ topleft, src });
+	}
+
+	bool Flush(void) {
+		const auto ret = GrpSurface_BlitBatch(sid, sprites);
+		sprites.clear();
+		return ret;
+	}
+};
@@ -71,6 +71,10 @@ template <class T> concept TEXTRENDER_BASE = requires(
 	// game state initialization.
 	{ t.Register(size) } -> std::same_as<TEXTRENDER_RECT_ID>;
 
+	// Releases a single text rectangle, whose space can then be reused by
+	// future Register() calls.
+	t.Free(rect_id);
+
 	// Invalidates all registered text rectangles.
 	t.Clear();
 	// --------------------
@@ -2,11 +2,12 @@
  *   Rectangle management for text rendering by packing each rectangle into a
  *   larger surface
  *
- *   The rectangle packing algorithm was adapted and simplified from
+ *   The guillotine splitting of empty spaces was adapted and simplified from
  *
  *   	https://github.com/TeamHypersomnia/rectpack2D
  *
- *   and enhanced with expansion into either direction.
+ *   and enhanced with expansion into either direction, and with freeing of
+ *   individual rectangles.
  */
 
 #include "game/text_packed.h"
@@ -100,70 +101,76 @@ created_splits insert_and_split(const PIXEL_SIZE& nw, const PIXEL_LTWH& sp)
 
 PIXEL_LTWH TEXTRENDER_PACKED::Insert(const PIXEL_SIZE& subrect_size)
 {
-	PIXEL_LTWH* closest = nullptr;
-
 	assert(subrect_size);
-	for(int i = static_cast<int>(spaces.size()) - 1; i >= 0; --i) {
-		const PIXEL_LTWH candidate = spaces[i];
 
-		if(!closest || (
-			(candidate.w * candidate.h) < (closest->w * closest->h)
+	// Best area fit. Leaves the larger spaces intact for larger rectangles.
+	std::optional<size_t> best;
+	for(size_t i = 0; i < spaces.size(); i++) {
+		const auto& candidate = spaces[i];
+		if((candidate.w < subrect_size.w) || (candidate.h < subrect_size.h)) {
+			continue;
+		}
+		if(!best || (
+			(candidate.w * candidate.h) <
+			(spaces[best.value()].w * spaces[best.value()].h)
 		)) {
-			closest = &spaces[i];
+			best = i;
 		}
+	}
 
-		const auto splits = insert_and_split(subrect_size, candidate);
-		if(splits) {
-			spaces[i] = spaces.back();
-			spaces.pop_back();
-
-			for (int s = 0; s < splits.count; ++s) {
-				SpaceAdd(splits.spaces[s]);
-			}
+	if(!best) {
+		// Might as well recurse for the assignment of the resulting rectangle
+		// to simplify the code.
+		Grow(subrect_size);
+		return Insert(subrect_size);
+	}
 
-			const PIXEL_LTWH ret = {
-				candidate.left, candidate.top, subrect_size.w, subrect_size.h
-			};
-			bounds.w = std::max(bounds.w, (ret.left + ret.w));
-			bounds.h = std::max(bounds.h, (ret.top  + ret.h));
-			return ret;
-		}
+	const PIXEL_LTWH candidate = spaces[best.value()];
+	const auto splits = insert_and_split(subrect_size, candidate);
+	assert(splits);
+	spaces[best.value()] = spaces.back();
+	spaces.pop_back();
+	for(int s = 0; s < splits.count; ++s) {
+		SpaceAdd(splits.spaces[s]);
 	}
 
-	// Expand the closest space in-place, but only if this would add fewer
-	// pixels than starting a new row or column. The bounds are resized
-	// accordingly during the actual insertion.
-	if(
-		closest &&
-		((subrect_size.w - closest->w) < subrect_size.h) &&
-		((subrect_size.h - closest->h) < subrect_size.w)
-	) {
-		closest->w = subrect_size.w;
-		closest->h = subrect_size.h;
+	const PIXEL_LTWH ret = {
+		candidate.left, candidate.top, subrect_size.w, subrect_size.h
+	};
+	bounds.w = std::max(bounds.w, (ret.left + ret.w));
+	bounds.h = std::max(bounds.h, (ret.top  + ret.h));
+	return ret;
+}
+
+void TEXTRENDER_PACKED::Grow(const PIXEL_SIZE& subrect_size)
+{
+	constexpr auto coord_max = std::numeric_limits<PIXEL_COORD>::max();
+
+	// Add a new column to the right or a new row at the bottom, whichever
+	// keeps the canvas closer to a square. If the new rectangle is larger
+	// than the canvas in the other dimension, the canvas also needs to be
+	// extended in that dimension, which creates a second empty space.
+	if(canvas.w <= canvas.h) {
+		assert(subrect_size.w <= (coord_max - canvas.w));
+		const auto h = std::max(canvas.h, subrect_size.h);
+		SpaceAdd(PIXEL_LTWH{ canvas.w, 0, subrect_size.w, h });
+		SpaceAdd(PIXEL_LTWH{ 0, canvas.h, canvas.w, (h - canvas.h) });
+		canvas = { (canvas.w + subrect_size.w), h };
 	} else {
-		constexpr auto coord_max = std::numeric_limits<PIXEL_COORD>::max();
-
-		if(bounds.w <= bounds.h) {
-			assert(subrect_size.w <= (coord_max - bounds.w));
-			SpaceAdd(PIXEL_LTWH{
-				bounds.w, 0, subrect_size.w, std::max(bounds.h, subrect_size.h)
-			});
-		} else {
-			assert(subrect_size.h <= (coord_max - bounds.h));
-			SpaceAdd(PIXEL_LTWH{
-				0, bounds.h, std::max(bounds.w, subrect_size.w), subrect_size.h
-			});
-		}
+		assert(subrect_size.h <= (coord_max - canvas.h));
+		const auto w = std::max(canvas.w, subrect_size.w);
+		SpaceAdd(PIXEL_LTWH{ 0, canvas.h, w, subrect_size.h });
+		SpaceAdd(PIXEL_LTWH{ canvas.w, 0, (w - canvas.w), canvas.h });
+		canvas = { w, (canvas.h + subrect_size.h) };
 	}
-	// Might as well recurse for the assignment of the resulting rectangle to
-	// simplify the code.
-	return Insert(subrect_size);
+	SpacesMerge();
 }
 
 PIXEL_LTWH TEXTRENDER_PACKED::Subrect(
 	TEXTRENDER_RECT_ID rect_id, std::optional<PIXEL_LTWH> maybe_subrect
 ) {
 	assert(rect_id < rects.size());
+	assert(rects[rect_id].live);
 	auto ret = rects[rect_id].rect;
 	if(maybe_subrect) {
 		const auto& subrect = maybe_subrect.value();
@@ -175,12 +182,110 @@ PIXEL_LTWH TEXTRENDER_PACKED::Subrect(
 	return ret;
 }
 
+void TEXTRENDER_PACKED::SpacesMerge()
+{
+	const auto merge = [](PIXEL_LTWH& a, const PIXEL_LTWH& b) {
+		if((a.top == b.top) && (a.h == b.h)) {
+			if((a.left + a.w) == b.left) {
+				a.w += b.w;
+				return true;
+			} else if((b.left + b.w) == a.left) {
+				a.left = b.left;
+				a.w += b.w;
+				return true;
+			}
+		} else if((a.left == b.left) && (a.w == b.w)) {
+			if((a.top + a.h) == b.top) {
+				a.h += b.h;
+				return true;
+			} else if((b.top + b.h) == a.top) {
+				a.top = b.top;
+				a.h += b.h;
+				return true;
+			}
+		}
+		return false;
+	};
+
+	// Text surfaces only hold a few dozen rectangles, so quadratic is fine.
+	bool merged;
+	do {
+		merged = false;
+		for(size_t i = 0; i < spaces.size(); i++) {
+			for(size_t j = (i + 1); j < spaces.size(); j++) {
+				if(merge(spaces[i], spaces[j])) {
+					spaces[j] = spaces.back();
+					spaces.pop_back();
+					merged = true;
+					j = i;
+				}
+			}
+		}
+	} while(merged);
+}
+
 TEXTRENDER_RECT_ID TEXTRENDER_PACKED::Register(const PIXEL_SIZE& size)
 {
-	rects.emplace_back(Insert(size));
+	if(freed) {
+		const auto fits = std::ranges::any_of(spaces, [&](const auto& space) {
+			return ((space.w >= size.w) && (space.h >= size.h));
+		});
+		const auto area_free = std::accumulate(
+			spaces.begin(), spaces.end(), 0, [](int sum, const auto& space) {
+				return (sum + (space.w * space.h));
+			}
+		);
+		if(!fits && (area_free >= (size.w * size.h))) {
+			Compact();
+		}
+	}
+
+	const auto rect = Insert(size);
+	const auto slot = std::ranges::find(rects, false, &RECT_AND_CONTENTS::live);
+	if(slot != rects.end()) {
+		*slot = RECT_AND_CONTENTS{ .rect = rect };
+		return static_cast<TEXTRENDER_RECT_ID>(slot - rects.begin());
+	}
+	rects.emplace_back(rect);
 	return static_cast<TEXTRENDER_RECT_ID>(rects.size() - 1);
 }
 
+void TEXTRENDER_PACKED::Free(TEXTRENDER_RECT_ID rect_id)
+{
+	assert(rect_id < rects.size());
+	auto& rect = rects[rect_id];
+	assert(rect.live);
+	rect.live = false;
+	rect.contents = std::nullopt;
+	SpaceAdd(rect.rect);
+	SpacesMerge();
+	freed = true;
+}
+
+void TEXTRENDER_PACKED::Compact()
+{
+	std::vector<TEXTRENDER_RECT_ID> order;
+	for(TEXTRENDER_RECT_ID i = 0; i < rects.size(); i++) {
+		if(rects[i].live) {
+			order.emplace_back(i);
+		}
+	}
+	std::ranges::stable_sort(order, std::greater{}, [this](auto rect_id) {
+		const auto& rect = rects[rect_id].rect;
+		return (rect.w * rect.h);
+	});
+
+	bounds = {};
+	canvas = {};
+	spaces.clear();
+	freed = false;
+	for(const auto rect_id : order) {
+		auto& rect = rects[rect_id];
+		rect.rect = Insert({ rect.rect.w, rect.rect.h });
+		rect.contents = std::nullopt;
+	}
+}
+
 bool TEXTRENDER_PACKED::Wipe()
 {
 	for(auto& rect : rects) {
@@ -192,8 +297,11 @@ bool TEXTRENDER_PACKED::Wipe()
 void TEXTRENDER_PACKED::Clear()
 {
 	bounds = {};
+	canvas = {};
 	spaces.clear();
 	rects.clear();
+	freed = false;
+	generation++;
 }
 
 bool TEXTRENDER_PACKED::Blit(
@@ -205,3 +313,17 @@ bool TEXTRENDER_PACKED::Blit(
 	const PIXEL_LTRB rect = Subrect(rect_id, subrect);
 	return GrpSurface_Blit(dst, SURFACE_ID::TEXT, rect);
 }
+
+bool TEXTRENDER_PACKED::BlitColumns(
+	TEXTRENDER_RECT_ID rect_id,
+	const PIXEL_LTWH& subrect,
+	std::span<const WINDOW_POINT> columns,
+	PIXEL_COORD column_w
+)
+{
+	// Like the per-column Blit() calls this replaces, each column is sourced
+	// from the next pixel to the right, even past the width of [rect_id].
+	auto rect = Subrect(rect_id, subrect);
+	rect.w = static_cast<PIXEL_COORD>(columns.size());
+	return GrpSurface_BlitColumns(SURFACE_ID::TEXT, rect, columns, column_w);
+}
@@ -13,50 +13,103 @@ protected:
 	struct RECT_AND_CONTENTS {
 		PIXEL_LTWH rect;
 		std::optional<Narrow::string> contents;
+
+		// `false` after Free(), until the slot is reused by Register().
+		bool live = true;
 	};
 
+	// Size of the area actually covered by rectangles, which determines the
+	// size of the surface.
 	PIXEL_SIZE bounds = {};
+
+	// Size of the area managed by the packer, including empty spaces that
+	// might lie outside [bounds]. All spaces and rectangles are disjoint.
+	PIXEL_SIZE canvas = {};
 	std::vector<PIXEL_LTWH> spaces;
 	std::vector<RECT_AND_CONTENTS> rects;
 
+	// Incremented by Clear(), which invalidates all IDs.
+	uint32_t generation = 0;
+
+	// Set by Free(), and reset by Compact().
+	bool freed = false;
+
 	template <class T> void SpaceAdd(T&& space) {
 		if((space.w > 0) && (space.h > 0)) {
 			spaces.emplace_back(std::forward<T>(space));
 		}
 	}
 
-	// Inserts a rectangle of the given size, expanding the empty space as
-	// needed.
+	// Inserts a rectangle of the given size into the smallest empty space it
+	// fits in, growing the canvas as needed.
 	PIXEL_LTWH Insert(const PIXEL_SIZE& subrect_size);
 
+	// Adds a new row or column of empty space that fits [subrect_size].
+	void Grow(const PIXEL_SIZE& subrect_size);
+
+	// Coalesces empty spaces that share a full edge, so that freed
+	// rectangles can be reused for larger ones.
+	void SpacesMerge();
+
 public:
 	PIXEL_LTWH Subrect(
 		TEXTRENDER_RECT_ID rect_id, std::optional<PIXEL_LTWH> maybe_subrect
 	);
 
+	// Compacts all live rectangles first if [size] doesn't fit into any empty
+	// space, but would fit into the total empty area left behind by Free().
+	// Growing the surface would re-render all rectangles anyway.
 	TEXTRENDER_RECT_ID Register(const PIXEL_SIZE& size);
 
+	// Returns the area of [rect_id] to the empty space, where subsequent
+	// Register() calls can reuse it without growing the surface. [rect_id] is
+	// invalid afterwards, and might be handed out again.
+	void Free(TEXTRENDER_RECT_ID rect_id);
+
+	// Re-packs all live rectangles from scratch in order of decreasing area,
+	// retaining their IDs. Since this moves rectangles, their contents are
+	// invalidated; the bounds might also shrink, recreating the surface.
+	void Compact();
+
 	bool Wipe();
 
-	// Resets both bounds and empty spaces.
+	// Resets the bounds, the canvas, and all empty spaces.
 	void Clear();
 
+	// Changes whenever Clear() invalidates all previously registered IDs.
+	uint32_t Generation() const {
+		return generation;
+	}
+
 	bool Blit(
 		WINDOW_POINT dst,
 		TEXTRENDER_RECT_ID rect_id,
 		std::optional<PIXEL_LTWH> subrect = std::nullopt
 	);
 
-	template <typename Self> bool Render(
+	// Blits one pixel column starting at the top-left of [subrect] to each
+	// point in [columns], as described for GrpSurface_BlitColumns(). Matches
+	// calling Blit() with a 1-pixel-wide [subrect] for each column, which
+	// means that [columns] can extend past the width of [rect_id] into
+	// whatever was packed next to it. The width of [subrect] is ignored.
+	bool BlitColumns(
+		TEXTRENDER_RECT_ID rect_id,
+		const PIXEL_LTWH& subrect,
+		std::span<const WINDOW_POINT> columns,
+		PIXEL_COORD column_w
+	);
+
+	// Calls [func] to render [contents] into [rect_id] if they differ from the
+	// contents rendered there before.
+	template <typename Self> bool Prerender(
 		this Self&& self,
-		WINDOW_POINT dst,
 		TEXTRENDER_RECT_ID rect_id,
 		Narrow::string_view contents,
-		std::invocable<TEXTRENDER_SESSION&> auto func,
-		std::optional<PIXEL_LTWH> subrect = std::nullopt
+		std::invocable<TEXTRENDER_SESSION&> auto func
 	) {
 		assert(rect_id < self.rects.size());
 		auto& rect = self.rects[rect_id];
+		assert(rect.live);
 		if(rect.contents != contents) {
 			auto maybe_session = self.Session(rect_id);
 			if(!maybe_session) {
@@ -65,6 +118,35 @@ public:
 			func(maybe_session.value());
 			rect.contents = contents;
 		}
+		return true;
+	}
+
+	template <typename Self> bool Render(
+		this Self&& self,
+		WINDOW_POINT dst,
+		TEXTRENDER_RECT_ID rect_id,
+		Narrow::string_view contents,
+		std::invocable<TEXTRENDER_SESSION&> auto func,
+		std::optional<PIXEL_LTWH> subrect = std::nullopt
+	) {
+		if(!self.Prerender(rect_id, contents, func)) {
+			return false;
+		}
 		return self.Blit(dst, rect_id, subrect);
 	}
+
+	template <typename Self> bool RenderColumns(
+		this Self&& self,
+		TEXTRENDER_RECT_ID rect_id,
+		Narrow::string_view contents,
+		std::invocable<TEXTRENDER_SESSION&> auto func,
+		const PIXEL_LTWH& subrect,
+		std::span<const WINDOW_POINT> columns,
+		PIXEL_COORD column_w
+	) {
+		if(!self.Prerender(rect_id, contents, func)) {
+			return false;
+		}
+		return self.BlitColumns(rect_id, subrect, columns, column_w);
+	}
 };
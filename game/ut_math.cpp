@@ -4,17 +4,24 @@
 /*                                                                           */
 
 #include "ut_math.h"
+#include "game/snapshot.h"
+#include <assert.h>
 #pragma message(PBGWIN_UT_MATH_H)
 
 
 constexpr uint32_t RAND_A = 22695477; // 0x015a4e35
 
 static uint32_t random_seed; // 乱数のたね //
+static const SNAPSHOT_STATE RandomState = { random_seed };
+static const SNAPSHOT_HASH RandomHash = { u8"Random", [](STATE_HASH& h) {
+	h.Add(random_seed);
+} };
 //uint32_t random_ref;
 
 
 ////ｓｉｎテーブル(ｃｏｓを含む)////
-extern const signed int SIN256[256+64] = {
+// Original hardcoded tables, kept as the reference for the generated ones.
+static constexpr signed int SIN256_ORIGINAL[256 + 64] = {
 	0,6,12,18,25,31,37,43,49,56,62,68,74,80,86,92,97,103,109,115,120,126,131,136,
 	142,147,152,157,162,167,171,176,181,185,189,193,197,201,205,209,212,216,219,
 	222,225,228,231,234,236,238,241,243,244,246,248,249,251,252,253,254,254,255,
@@ -35,12 +42,11 @@ extern const signed int SIN256[256+64] = {
 	253,254,254,255,255,255
 };
 
-////ｃｏｓテーブル、というのかな？////
-const signed int *COS256 = &SIN256[64];
+static_assert(std::ranges::equal(SIN256, SIN256_ORIGINAL));
 
 
 ////ａｔａｎテーブル////
-static const std::array<uint8_t, 256> ATAN256 = {
+static constexpr std::array<uint8_t, 256> ATAN256_ORIGINAL = {
 	0, 0, 0, 0, 1, 1, 1, 1,  1, 1, 2, 2, 2, 2, 2, 2,
 	3, 3, 3, 3, 3, 3, 3, 4,  4, 4, 4, 4, 4, 5, 5, 5,
 	5, 5, 5, 6, 6, 6, 6, 6,  6, 6, 7, 7, 7, 7, 7, 7,
@@ -59,18 +65,23 @@ static const std::array<uint8_t, 256> ATAN256 = {
 	31,31,31,31,31,31,31,31, 31,31,32,32,32,32,32,32
 };
 
+// 256 × atan([i] / 256) / 2π, rounded to the nearest integer.
+static constexpr auto ATAN256 = [] {
+	std::array<uint8_t, 256> ret;
+	for(size_t i = 0; i < ret.size(); i++) {
+		const auto v = (Trig::Atan(i / 256.0) * (128 / Trig::PI));
+		ret[i] = static_cast<uint8_t>(v + 0.5);
+	}
+	return ret;
+}();
+static_assert(ATAN256 == ATAN256_ORIGINAL);
 
-int sinl(uint8_t deg, int length)
-{
-	//return ((long)sinm(deg)*length)/256;
-	return ((static_cast<long>(sinm(deg)) * length) >> 8);
-}
+// Spot checks of the inline functions against hand-computed values.
+static_assert(sinl(0x40, 1000) == 1000);
+static_assert(sinl(0xC0, 1000) == -1000);
+static_assert(cosl(0x80, 1000) == -1000);
+static_assert(sinl(0x20, -64) == -46);
 
-int cosl(uint8_t deg, int length)
-{
-	//return ((long)cosm(deg)*length)/256;
-	return ((static_cast<long>(cosm(deg)) * length) >> 8);
-}
 
 // length*256/(SIN(deg)>0 ? SIN(deg) : 256) //
 int sinDiv(uint8_t deg, int length)
@@ -130,6 +141,81 @@ uint8_t atan8(int x, int y)
 	return ret;
 }
 
+void sinl_batch(
+	std::span<int> ret,
+	std::span<const uint8_t> deg,
+	std::span<const int> length
+)
+{
+	assert(deg.size() == ret.size());
+	assert(length.size() == ret.size());
+	for(size_t i = 0; i < ret.size(); i++) {
+		ret[i] = sinl(deg[i], length[i]);
+	}
+}
+
+void cosl_batch(
+	std::span<int> ret,
+	std::span<const uint8_t> deg,
+	std::span<const int> length
+)
+{
+	assert(deg.size() == ret.size());
+	assert(length.size() == ret.size());
+	for(size_t i = 0; i < ret.size(); i++) {
+		// Since SIN256 repeats after 256 entries, this is identical to
+		// cosm(). Going through the COS256 pointer keeps GCC from vectorizing
+		// the loop.
+		ret[i] = sinl(static_cast<uint8_t>(deg[i] + 0x40), length[i]);
+	}
+}
+
+// ATAN256 widened to 32 bits for SIMD gather instructions. The scaled
+// quotient of equal coordinates is exactly ATAN256.size(), so the extra entry
+// holds their result of 0x20, which stays the same when subtracted from 0x40.
+static constexpr auto ATAN256_BATCH = [] {
+	std::array<int32_t, (ATAN256.size() + 1)> ret;
+	std::ranges::copy(ATAN256, ret.begin());
+	ret.back() = 0x20;
+	return ret;
+}();
+
+void atan8_batch(
+	std::span<uint8_t> ret, std::span<const int> x, std::span<const int> y
+)
+{
+	assert(x.size() == ret.size());
+	assert(y.size() == ret.size());
+
+	// Returns ([cond] ? ([base] - [v]) : [v]) for a [cond] of 0 or 1, as
+	// two's complement arithmetic. GCC turns equivalent conditional
+	// expressions into branches that prevent vectorization.
+	const auto flip = [](int v, int base, int cond) {
+		return ((cond * base) + ((v ^ -cond) + cond));
+	};
+
+	for(size_t i = 0; i < ret.size(); i++) {
+		// The 64-bit integer division of atan8() has no SIMD equivalent. The
+		// scaled numerator is < 2⁴⁰ and fits into the mantissa, and a
+		// non-integer quotient is at least 2⁻³¹ away from the next integer,
+		// far more than the rounding error of a quotient ≤ 256. Truncating
+		// therefore yields the same index.
+		// Computing the minimum and maximum on doubles also keeps GCC from
+		// branching around the division.
+		const double x_abs = abs(x[i]);
+		const double y_abs = abs(y[i]);
+		const double num = (std::min)(x_abs, y_abs);
+		const double den = (std::max)({ x_abs, y_abs, 1.0 });
+		const auto array_i = static_cast<int>((num * ATAN256.size()) / den);
+		const int v = ATAN256_BATCH[array_i];
+
+		auto r = flip(v, 0x40, (x_abs <= y_abs));
+		r = flip(r, 0x80, (x[i] < 0));
+		r = flip(r, 0x00, (y[i] < 0));
+		ret[i] = (r & -int((x[i] | y[i]) != 0));
+	}
+}
+
 void rnd_seed_set(uint32_t val)
 {
 	random_seed = val;
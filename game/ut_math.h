@@ -30,14 +30,85 @@ import std.compat;
 #define cosm(deg) (COS256[(unsigned char)deg]) // COSﾃｰﾌﾞﾙ参照用ﾏｸﾛ
 
 
+// Compile-time trigonometry
+// -------------------------
+// Just precise enough to exactly reproduce the lookup tables of the original
+// game from their definitions. Not meant to be used at runtime.
+
+namespace Trig {
+	constexpr double PI = std::numbers::pi;
+
+	// Taylor series, converging quickly for |[x]| ≤ π/4.
+	constexpr double Sin(double x) {
+		double term = x;
+		double ret = x;
+		for(int k = 1; k < 12; k++) {
+			term *= (-(x * x) / ((2 * k) * ((2 * k) + 1)));
+			ret += term;
+		}
+		return ret;
+	}
+
+	// Taylor series, converging quickly for |[x]| ≤ π/4.
+	constexpr double Cos(double x) {
+		double term = 1.0;
+		double ret = 1.0;
+		for(int k = 1; k < 12; k++) {
+			term *= (-(x * x) / (((2 * k) - 1) * (2 * k)));
+			ret += term;
+		}
+		return ret;
+	}
+
+	// Valid for 0 ≤ [x] ≤ 1. Shifts the argument of the Taylor series by
+	// π/4 if necessary to keep it below tan(π/8).
+	constexpr double Atan(double x) {
+		const bool shift = (x > 0.41421356);
+		const double arg = (shift ? ((x - 1.0) / (x + 1.0)) : x);
+		double power = arg;
+		double ret = arg;
+		for(int k = 1; k < 40; k++) {
+			power *= -(arg * arg);
+			ret += (power / ((2 * k) + 1));
+		}
+		return (shift ? ((PI / 4) + ret) : ret);
+	}
+}
+// -------------------------
+
+
 // 定数 //
-extern const signed int SIN256[256+64];
-extern const signed int *COS256;
+// 256 × sin(2π × i / 256), truncated toward zero. The first quadrant is
+// mirrored into the other ones, which keeps the exact values at multiples of
+// π/2. ut_math.cpp verifies this against the original table.
+inline constexpr auto SIN256 = [] {
+	std::array<signed int, (256 + 64)> ret;
+	for(size_t i = 0; i < ret.size(); i++) {
+		const auto q_half = (i % 128);
+		const auto q = ((q_half <= 64) ? q_half : (128 - q_half));
+		const auto v = ((q <= 32)
+			? Trig::Sin(q * (Trig::PI / 128))
+			: Trig::Cos((64 - q) * (Trig::PI / 128))
+		);
+		const auto truncated = static_cast<signed int>(v * 256);
+		ret[i] = (((i % 256) < 128) ? truncated : -truncated);
+	}
+	return ret;
+}();
+inline constexpr const signed int *COS256 = &SIN256[64];
 
 
 // 三角関数2 //
-int sinl(uint8_t deg, int length);	// (SIN(deg) * length) / 256)
-int cosl(uint8_t deg, int length);	// (COS(deg) * length) / 256)
+// Inline, so that loops over arrays of angles or lengths can be vectorized.
+constexpr int sinl(uint8_t deg, int length)	// (SIN(deg) * length) / 256)
+{
+	return ((static_cast<long>(sinm(deg)) * length) >> 8);
+}
+
+constexpr int cosl(uint8_t deg, int length)	// (COS(deg) * length) / 256)
+{
+	return ((static_cast<long>(cosm(deg)) * length) >> 8);
+}
 
 // ((length * 256) / ((SIN(deg) > 0) ? SIN(deg) : 256))
 int sinDiv(uint8_t deg, int length);
@@ -48,6 +119,28 @@ int cosDiv(uint8_t deg, int length);
 uint8_t atan8(int x, int y);	// ３２ビット版です
 
 
+// 配列版 //
+// Write the result of the scalar function for every element of the input
+// spans to the same element of [ret]. All spans must have the same size. The
+// loops are branchless, so that compilers can vectorize them, and return the
+// exact same values as the scalar versions for every input in their domain.
+void sinl_batch(
+	std::span<int> ret,
+	std::span<const uint8_t> deg,
+	std::span<const int> length
+);
+void cosl_batch(
+	std::span<int> ret,
+	std::span<const uint8_t> deg,
+	std::span<const int> length
+);
+
+// [x] and [y] must not be INT_MIN, for which atan8() is undefined.
+void atan8_batch(
+	std::span<uint8_t> ret, std::span<const int> x, std::span<const int> y
+);
+
+
 // 平方根(整数版) //
 // Calculates √[s], rounded to the nearest integer.
 int32_t isqrt(int32_t s);
@@ -10,7 +10,7 @@
 #include <fcntl.h> // For `AT_FDCWD`
 #include <stdio.h> // For fileno()
 #include <sys/stat.h> // The stat types aren't part of the `std` module either
-#include <unistd.h> // For dup() and close()
+#include <unistd.h> // For dup(), close(), and fsync()
 
 #include "platform/file.h"
 
@@ -79,3 +79,45 @@ bool File_CloseWithTimestamps(
 	maybe_timestamps.reset();
 	return ret;
 }
+
+bool File_IsReadOnly(const char8_t *fn)
+{
+	const auto *s = std::bit_cast<const char *>(fn);
+	return ((access(s, F_OK) == 0) && (access(s, W_OK) != 0));
+}
+
+bool File_Sync(SDL_IOStream *context)
+{
+	if(!SDL_FlushIO(context)) {
+		return false;
+	}
+	const SDL_PropertiesID props = SDL_GetIOProperties(context);
+	const int fd = SDL_GetNumberProperty(
+		props, SDL_PROP_IOSTREAM_FILE_DESCRIPTOR_NUMBER, -1
+	);
+	return ((fd != -1) && (fsync(fd) == 0));
+}
+
+bool File_RenameReplace(const char8_t *src, const char8_t *dst)
+{
+	const auto *dst_s = std::bit_cast<const char *>(dst);
+	if(rename(std::bit_cast<const char *>(src), dst_s) != 0) {
+		return false;
+	}
+
+	// The rename itself only becomes durable once the directory entry has
+	// been synced as well. It has already happened at this point, though, so
+	// a failure here doesn't affect the result.
+	const auto dst_sv = std::string_view{ dst_s };
+	const auto slash = dst_sv.find_last_of('/');
+	const auto dir = ((slash != std::string_view::npos)
+		? std::string{ dst_sv.substr(0, (slash + 1)) }
+		: std::string{ "." }
+	);
+	const auto dir_fd = open(dir.c_str(), (O_RDONLY | O_DIRECTORY));
+	if(dir_fd != -1) {
+		fsync(dir_fd);
+		close(dir_fd);
+	}
+	return true;
+}
@@ -34,3 +34,9 @@ TIME_OF_DAY Time_NowLocal()
 		.second = static_cast<uint8_t>(tm.tm_sec),
 	};
 }
+
+int64_t Time_NowUnix()
+{
+	const auto now = std::chrono::system_clock::now().time_since_epoch();
+	return std::chrono::duration_cast<std::chrono::seconds>(now).count();
+}
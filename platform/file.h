@@ -21,6 +21,45 @@ bool File_CloseWithTimestamps(
 	SDL_IOStream *&& context, std::unique_ptr<FILE_TIMESTAMPS> maybe_timestamps
 );
 
+// Crash-safe file replacement
+// ---------------------------
+// Writes go to a temporary file next to the target, which only replaces the
+// target after all of its data has reached the disk. A crash or failed write
+// at any point therefore leaves the previous version of the target intact.
+// Read-only targets are never replaced.
+
+// Opens a temporary file for replacing [fn]. Returns a `nullptr` if [fn] is
+// read-only or the temporary file could not be created.
+SDL_IOStream *File_ReplaceStart(const char8_t *fn);
+
+// Flushes [context] to disk, closes it with File_CloseWithTimestamps(), and
+// renames it over [fn]. [context] must have been returned by
+// File_ReplaceStart() for the same [fn]. On failure, the temporary file is
+// removed and [fn] stays untouched.
+bool File_ReplaceCommit(
+	SDL_IOStream *&& context,
+	const char8_t *fn,
+	std::unique_ptr<FILE_TIMESTAMPS> maybe_timestamps = nullptr
+);
+
+// Closes and removes a temporary file returned by File_ReplaceStart() for
+// [fn], leaving [fn] untouched.
+void File_ReplaceAbort(SDL_IOStream *&& context, const char8_t *fn);
+
+// Replaces [fn] with the given data in one go.
+bool File_Replace(const char8_t *fn, BYTE_BUFFER_BORROWED data);
+
+// Appends [data] to [fn], creating it if necessary, and flushes it to disk.
+// Unlike a replacement, a crash during the write can leave a partial copy of
+// [data] at the end of [fn], which readers must be able to skip.
+bool File_Append(const char8_t *fn, BYTE_BUFFER_BORROWED data);
+
+// Platform-specific building blocks of the functions above.
+bool File_IsReadOnly(const char8_t *fn);
+bool File_Sync(SDL_IOStream *context);
+bool File_RenameReplace(const char8_t *src, const char8_t *dst);
+// ---------------------------
+
 // SDL wrappers
 // ------------
 
@@ -80,6 +80,18 @@ bool GrpBackend_PaletteSet(const PALETTE& pal);
 
 struct FILE_STREAM_WRITE;
 void GrpBackend_Flip(bool take_screenshot);
+
+struct GRAPHICS_STATS {
+	// Calls that submit geometry to the underlying API.
+	uint32_t draw_calls;
+
+	// Draw calls whose texture or blend mode differ from the previous one.
+	uint32_t state_changes;
+};
+
+// Returns the statistics collected since the last call, and resets them.
+// Backends that don't collect any return zeros.
+GRAPHICS_STATS GrpBackend_StatsTake(void);
 /// -------
 
 /// Surfaces
@@ -122,6 +134,46 @@ void GrpSurface_BlitOpaque(
 	WINDOW_POINT topleft, SURFACE_ID sid, const PIXEL_LTRB& src
 );
 
+// Blits the 1-pixel-wide columns of the given [src] rectangle inside [sid],
+// in order, to the top-left points in [columns], repeating each column
+// [column_w] times to the right. Covers the same rectangles as the
+// corresponding sequence of GrpSurface_Blit() calls, but allows backends to
+// submit the whole strip as a single draw call, which isn't guaranteed to be
+// pixel-identical. [columns] must have one point for each column of [src].
+// Returns `true` if any part of the strip was blitted.
+bool GrpSurface_BlitColumns(
+	SURFACE_ID sid,
+	const PIXEL_LTRB& src,
+	std::span<const WINDOW_POINT> columns,
+	PIXEL_COORD column_w
+);
+
+// A single GrpSurface_Blit() call, for batching.
+struct GRP_SPRITE {
+	WINDOW_POINT topleft;
+	PIXEL_LTRB src;
+};
+
+// Blits all [sprites] from [sid] in order. Covers the same rectangles as the
+// corresponding sequence of GrpSurface_Blit() calls, but allows backends to
+// submit them as a single draw call, which isn't guaranteed to be
+// pixel-identical. Returns `true` if any sprite was blitted.
+bool GrpSurface_BlitBatch(SURFACE_ID sid, std::span<const GRP_SPRITE> sprites);
+
+// Fades [sid] to the given brightness in all subsequent blits, without
+// changing its pixels, and with the same colors as PALETTE::Fade(). Channeled
+// backends fade the blitted pixels; fading to white only applies to opaque
+// blits. Palettized backends fade the palette range of every surface that was
+// blitted during a frame when flipping, but only upload a new palette if any
+// of these brightness values changed since the last flip. Returns `false` if
+// the backend can't fade at all.
+bool GrpSurface_SetBrightness(SURFACE_ID sid, uint16_t brightness);
+
+// Limits palette fades of [sid] to the given inclusive range of colors.
+// Surfaces fade the entire palette by default, and are reset to that default
+// when (re)loaded. Ignored by channeled backends.
+void GrpSurface_SetPaletteRange(SURFACE_ID sid, uint8_t first, uint8_t last);
+
 #ifdef WIN32
 // Win32 GDI text rendering bridge
 // -------------------------------
@@ -11,8 +11,37 @@
 bool Key_Start(void);	// キー入力開始
 void Key_End(void);	// キー入力終了
 
+// Reads all pending input events into [Key_Data], [Pad_Data], and
+// [SystemKey_Data]. Keys that were both pressed and released since the last
+// call are reported as pressed for one call.
 void Key_Read(void);
 
+// Input age statistics
+// --------------------
+// The age of an input event is the time between the OS reporting it and the
+// Key_Read() call that consumed it.
+
+struct INPUT_AGE_STATS {
+	uint32_t events = 0;
+	uint64_t sum_ns = 0;
+	uint64_t max_ns = 0;
+
+	void Add(uint64_t age_ns) {
+		events++;
+		sum_ns += age_ns;
+		max_ns = (std::max)(max_ns, age_ns);
+	}
+
+	uint64_t MeanNS(void) const {
+		return (events ? (sum_ns / events) : 0);
+	}
+};
+
+// Returns the statistics accumulated across all Key_Read() calls since the
+// last call to this function, and starts a new accumulation period.
+INPUT_AGE_STATS Key_AgeStatsTake(void);
+// --------------------
+
 // Returns:
 // • ≥1: ID of the single gamepad button that is being pressed
 // •  0: More than one gamepad button is being pressed
@@ -10,6 +10,7 @@
 
 #include "game/bgm_track.h"
 #include "game/defer.h"
+#include "game/spectrum.h"
 #include "platform/snd_backend.h"
 
 // Helpers
@@ -68,6 +69,10 @@ static ma_result BGM_GetDataFormat(
 	return MA_SUCCESS;
 }
 
+// Only the most recently loaded track is fed into the spectrum analyzer, so
+// that crossfades don't interleave two tracks.
+static std::atomic<const BGM_OBJ *> BGMTapped = nullptr;
+
 static ma_result BGM_Read(
 	ma_data_source* pDataSource,
 	void* pFramesOut,
@@ -87,6 +92,12 @@ static ma_result BGM_Read(
 	if(!bgm->track->Decode({static_cast<std::byte *>(pFramesOut), buf_size})) {
 		return MA_INVALID_DATA;
 	}
+	if(bgm == BGMTapped.load(std::memory_order_relaxed)) {
+		Spectrum_Feed(
+			{ static_cast<const std::byte *>(pFramesOut), buf_size },
+			bgm->track->pcmf
+		);
+	}
 	*pFramesRead = frameCount;
 	return MA_SUCCESS;
 }
@@ -129,9 +140,13 @@ struct SE {
 
 static ma_engine Engine;
 static ma_sound_group SEGroup;
-static BGM_OBJ BGMObj;
 static SE SndObj[SND_OBJ_MAX];
 
+// Two objects, to keep the previous track playing during a crossfade.
+static BGM_OBJ BGMObjs[2];
+static BGM_OBJ *BGMObj = &BGMObjs[0];
+static ma_uint64 BGMCrossfadeFrames = 0;
+
 float x_to_linear(int x)
 {
 	// The basic dB→linear conversion formula. (linear = 10 ^ (dB / 20))
@@ -145,7 +160,14 @@ float x_to_linear(int x)
 
 bool SndBackend_Init(void)
 {
-	return (ma_engine_init(nullptr, &Engine) == MA_SUCCESS);
+	auto config = ma_engine_config_init();
+	if(Snd_Offline) {
+		// Would otherwise come from the device.
+		config.noDevice = MA_TRUE;
+		config.channels = 2;
+		config.sampleRate = 48000;
+	}
+	return (ma_engine_init(&config, &Engine) == MA_SUCCESS);
 }
 
 void SndBackend_Cleanup(void)
@@ -160,78 +182,121 @@ bool SndBackend_BGMInit(void)
 
 void SndBackend_BGMCleanup(void)
 {
-	BGMObj.Clear();
+	for(auto& obj : BGMObjs) {
+		obj.Clear();
+	}
+	BGMCrossfadeFrames = 0;
+}
+
+static BGM_OBJ& BGMOther(void)
+{
+	return ((BGMObj == &BGMObjs[0]) ? BGMObjs[1] : BGMObjs[0]);
 }
 
-bool SndBackend_BGMLoad(std::shared_ptr<BGM::TRACK> track)
+bool SndBackend_BGMLoad(
+	std::shared_ptr<BGM::TRACK> track, std::chrono::milliseconds crossfade
+)
 {
 	ma_result result = MA_SUCCESS;
 
-	BGMObj.Clear();
-	BGMObj.track = track;
+	BGMCrossfadeFrames = 0;
+	if(
+		(crossfade > std::chrono::milliseconds::zero()) &&
+		BGMObj->track &&
+		ma_sound_is_playing(&BGMObj->sound)
+	) {
+		// The new track goes into the other slot, replacing whatever might
+		// have still been fading out there.
+		BGMObj = &BGMOther();
+		BGMCrossfadeFrames = (
+			(crossfade.count() * ma_engine_get_sample_rate(&Engine)) / 1000
+		);
+	}
+	BGMObj->Clear();
+	BGMObj->track = track;
+	BGMTapped.store(BGMObj, std::memory_order_relaxed);
 
 	auto config = ma_data_source_config_init();
 	config.vtable = &BGM_VTABLE;
 
-	result = ma_data_source_init(&config, &BGMObj.data_source);
+	result = ma_data_source_init(&config, &BGMObj->data_source);
 	if(result != MA_SUCCESS) {
 		return result;
 	}
 	result = ma_sound_init_from_data_source(
 		&Engine,
-		&BGMObj.data_source,
+		&BGMObj->data_source,
 		MA_SOUND_FLAG_NO_SPATIALIZATION,
 		nullptr,
-		&BGMObj.sound
+		&BGMObj->sound
 	);
 	if(result != MA_SUCCESS) {
-		return BGMObj.Clear();
+		BGMCrossfadeFrames = 0;
+		return BGMObj->Clear();
 	}
 	return true;
 }
 
 void SndBackend_BGMPlay(void)
 {
-	if(!BGMObj.track) {
+	if(!BGMObj->track) {
 		return;
 	}
-	ma_sound_start(&BGMObj.sound);
+	if(BGMCrossfadeFrames > 0) {
+		// Pin both fades to the same engine frame, so that the sum stays
+		// constant across the crossfade.
+		auto& prev = BGMOther();
+		const auto now = ma_engine_get_time_in_pcm_frames(&Engine);
+		ma_sound_set_fade_in_pcm_frames(
+			&BGMObj->sound, 0.0f, 1.0f, BGMCrossfadeFrames
+		);
+		ma_sound_set_start_time_in_pcm_frames(&BGMObj->sound, now);
+		if(prev.track) {
+			ma_sound_set_stop_time_with_fade_in_pcm_frames(
+				&prev.sound, (now + BGMCrossfadeFrames), BGMCrossfadeFrames
+			);
+		}
+		BGMCrossfadeFrames = 0;
+	}
+	ma_sound_start(&BGMObj->sound);
 }
 
 void SndBackend_BGMStop(void)
 {
-	if(!BGMObj.track) {
-		return;
+	BGMCrossfadeFrames = 0;
+	for(auto& obj : BGMObjs) {
+		if(obj.track) {
+			ma_sound_stop(&obj.sound);
+		}
 	}
-	ma_sound_stop(&BGMObj.sound);
 }
 
 std::chrono::milliseconds SndBackend_BGMPlayTime(void)
 {
-	if(!BGMObj.track) {
+	if(!BGMObj->track) {
 		return std::chrono::milliseconds::zero();
 	}
-	const auto ret = ma_sound_get_time_in_milliseconds(&BGMObj.sound);
+	const auto ret = ma_sound_get_time_in_milliseconds(&BGMObj->sound);
 	return std::chrono::milliseconds{ ret };
 }
 
 void SndBackend_BGMUpdateVolume(void)
 {
-	if(!BGMObj.track) {
+	if(!BGMObj->track) {
 		return;
 	}
 	ma_sound_set_volume(
-		&BGMObj.sound, (Snd_BGMGainFactor * VolumeFactorSquare(Snd_VolumeBGM))
+		&BGMObj->sound, (Snd_BGMGainFactor * VolumeFactorSquare(Snd_VolumeBGM))
 	);
 }
 
 void SndBackend_BGMUpdateTempo(void)
 {
-	if(!BGMObj.track) {
+	if(!BGMObj->track) {
 		return;
 	}
 	const auto t = (static_cast<float>(Snd_BGMTempoNum) / Snd_BGMTempoDenom);
-	ma_sound_set_pitch(&BGMObj.sound, t);
+	ma_sound_set_pitch(&BGMObj->sound, t);
 }
 
 bool SndBackend_SEInit(void)
@@ -403,3 +468,34 @@ void SndBackend_ResumeAll(void)
 {
 	ma_engine_start(&Engine);
 }
+
+std::optional<SND_OFFLINE_FORMAT> SndBackend_OfflineStart(void)
+{
+	// The node graph can be read from any thread once the device has stopped.
+	if(
+		ma_engine_get_device(&Engine) &&
+		(ma_engine_stop(&Engine) != MA_SUCCESS)
+	) {
+		return std::nullopt;
+	}
+	return SND_OFFLINE_FORMAT{
+		.rate = ma_engine_get_sample_rate(&Engine),
+		.channels = static_cast<uint16_t>(ma_engine_get_channels(&Engine)),
+	};
+}
+
+void SndBackend_OfflineRender(std::span<float> out)
+{
+	const auto channels = ma_engine_get_channels(&Engine);
+	const auto frames = (out.size() / channels);
+	ma_uint64 read = 0;
+	ma_engine_read_pcm_frames(&Engine, out.data(), frames, &read);
+	std::ranges::fill(out.subspan(read * channels), 0.0f);
+}
+
+void SndBackend_OfflineEnd(void)
+{
+	if(ma_engine_get_device(&Engine)) {
+		ma_engine_start(&Engine);
+	}
+}
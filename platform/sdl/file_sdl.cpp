@@ -46,3 +46,69 @@ bool SDL_SaveFile(const char8_t *file, const void *data, size_t datasize)
 {
 	return SDL_SaveFile(std::bit_cast<const char *>(file), data, datasize);
 }
+
+// Crash-safe file replacement
+// ---------------------------
+
+static std::u8string File_ReplaceTempFN(const char8_t *fn)
+{
+	return (std::u8string{ fn } + u8".tmp");
+}
+
+SDL_IOStream *File_ReplaceStart(const char8_t *fn)
+{
+	if(File_IsReadOnly(fn)) {
+		return nullptr;
+	}
+	return SDL_IOFromFile(File_ReplaceTempFN(fn).c_str(), "wb");
+}
+
+bool File_ReplaceCommit(
+	SDL_IOStream *&& context,
+	const char8_t *fn,
+	std::unique_ptr<FILE_TIMESTAMPS> maybe_timestamps
+)
+{
+	const auto temp_fn = File_ReplaceTempFN(fn);
+	const auto synced = File_Sync(context);
+	const auto closed = File_CloseWithTimestamps(
+		std::move(context), std::move(maybe_timestamps)
+	);
+	if(synced && closed && File_RenameReplace(temp_fn.c_str(), fn)) {
+		return true;
+	}
+	SDL_RemovePath(std::bit_cast<const char *>(temp_fn.c_str()));
+	return false;
+}
+
+void File_ReplaceAbort(SDL_IOStream *&& context, const char8_t *fn)
+{
+	SDL_CloseIO(context);
+	SDL_RemovePath(std::bit_cast<const char *>(File_ReplaceTempFN(fn).c_str()));
+}
+
+bool File_Replace(const char8_t *fn, BYTE_BUFFER_BORROWED data)
+{
+	auto *stream = File_ReplaceStart(fn);
+	if(!stream) {
+		return false;
+	}
+	if(!SDL_MustWriteIO(stream, data.data(), data.size())) {
+		File_ReplaceAbort(std::move(stream), fn);
+		return false;
+	}
+	return File_ReplaceCommit(std::move(stream), fn);
+}
+
+bool File_Append(const char8_t *fn, BYTE_BUFFER_BORROWED data)
+{
+	auto *stream = SDL_IOFromFile(fn, "ab");
+	if(!stream) {
+		return false;
+	}
+	const auto written = (
+		SDL_MustWriteIO(stream, data.data(), data.size()) && File_Sync(stream)
+	);
+	return (SDL_CloseIO(stream) && written);
+}
+// ---------------------------
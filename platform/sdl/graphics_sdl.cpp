@@ -65,10 +65,21 @@ SDL_Renderer **Renderer = &PrimaryRenderer;
 // Storing their associated renderer (primary or software) in the user data.
 ENUMARRAY<SDL_Texture *, SURFACE_ID> Textures;
 
+// White blended over opaque blits of each texture, for brightness values
+// above [BRIGHTNESS_NORMAL]. Color modulation can only darken.
+ENUMARRAY<uint8_t, SURFACE_ID> Whiten;
+
 GRAPHICS_GEOMETRY_SDL GrpGeomSDL;
 
 static RGBA Col = { 0, 0, 0, 0xFF };
 static SDL_BlendMode AlphaMode = SDL_BLENDMODE_NONE;
+
+static GRAPHICS_STATS Stats;
+
+// Texture and blend mode of the previous draw call.
+static std::pair<SDL_Texture *, SDL_BlendMode> StatsState = {
+	nullptr, SDL_BLENDMODE_INVALID
+};
 /// -----
 
 // Compile-time index buffers
@@ -241,6 +252,23 @@ std::optional<GRAPHICS_FULLSCREEN_FLAGS> HelpSwitchFullscreen(
 	}
 	return fs_actual;
 }
+
+// Counts a draw call with the given texture, or an untextured one with the
+// current draw blend mode if [tex] is a `nullptr`.
+void StatsCountDraw(SDL_Texture *tex)
+{
+	std::pair<SDL_Texture *, SDL_BlendMode> state = {
+		tex, SDL_BLENDMODE_INVALID
+	};
+	if(tex) {
+		SDL_GetTextureBlendMode(tex, &state.second);
+	} else {
+		SDL_GetRenderDrawBlendMode(*Renderer, &state.second);
+	}
+	Stats.draw_calls++;
+	Stats.state_changes += (state != StatsState);
+	StatsState = state;
+}
 // -------
 
 // Pretty API version strings
@@ -830,7 +858,9 @@ void TakeScreenshot(void)
 	if(SoftwareRenderer) {
 		// Software rendering is the ideal case for screenshots, because we
 		// already have a system-memory surface we can save.
-		Grp_ScreenshotSave(SoftwareSurface, t_start);
+		if(!Grp_ScreenshotSave(SoftwareSurface, t_start)) {
+			Log_Fail(LOG_CAT, "Error saving screenshot");
+		}
 		return;
 	}
 
@@ -840,7 +870,9 @@ void TakeScreenshot(void)
 		return;
 	}
 	defer(SDL_DestroySurface(src));
-	Grp_ScreenshotSave(src, t_start);
+	if(!Grp_ScreenshotSave(src, t_start)) {
+		Log_Fail(LOG_CAT, "Error saving screenshot");
+	}
 }
 
 void GrpBackend_Flip(bool take_screenshot)
@@ -890,6 +922,11 @@ void GrpBackend_Flip(bool take_screenshot)
 		SDL_RenderPresent(PrimaryRenderer);
 	}
 }
+
+GRAPHICS_STATS GrpBackend_StatsTake(void)
+{
+	return std::exchange(Stats, {});
+}
 /// -------
 
 /// Surfaces
@@ -901,6 +938,7 @@ bool CreateTextureWithFormat(
 {
 	auto& tex = Textures[sid];
 	tex = SafeDestroy(SDL_DestroyTexture, tex);
+	Whiten[sid] = 0;
 
 	tex = SDL_CreateTexture(
 		*Renderer, fmt, SDL_TEXTUREACCESS_STREAMING, size.w, size.h
@@ -928,6 +966,7 @@ bool GrpSurface_Load(SURFACE_ID sid, BMP_OWNED&& bmp)
 {
 	auto& tex = Textures[sid];
 	tex = SafeDestroy(SDL_DestroyTexture, tex);
+	Whiten[sid] = 0;
 
 	auto *rwops = SDL_IOFromMem(bmp.buffer.get(), bmp.buffer.size());
 	auto *surf = SDL_LoadBMP_IO(rwops, 1);
@@ -1009,6 +1048,7 @@ bool GrpSurface_Blit(
 		.w = static_cast<float>(rect_src.w),
 		.h = static_cast<float>(rect_src.h),
 	};
+	StatsCountDraw(tex);
 	return SDL_RenderTexture(*Renderer, tex, &rect_src, &rect_dst);
 }
 
@@ -1022,6 +1062,176 @@ void GrpSurface_BlitOpaque(
 	SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_NONE);
 	GrpSurface_Blit(topleft, sid, src);
 	SDL_SetTextureBlendMode(tex, prev);
+
+	// Leaves the draw state as DrawWithAlpha() does.
+	if(const auto white = Whiten[sid]) {
+		const auto size = src.Size();
+		const SDL_FRect rect = {
+			.x = static_cast<float>(topleft.x),
+			.y = static_cast<float>(topleft.y),
+			.w = static_cast<float>(size.w),
+			.h = static_cast<float>(size.h),
+		};
+		SDL_SetRenderDrawBlendMode(*Renderer, SDL_BLENDMODE_BLEND);
+		SDL_SetRenderDrawColor(*Renderer, 0xFF, 0xFF, 0xFF, white);
+		StatsCountDraw(nullptr);
+		SDL_RenderFillRect(*Renderer, &rect);
+		SDL_SetRenderDrawColor(*Renderer, Col.r, Col.g, Col.b, 0xFF);
+		SDL_SetRenderDrawBlendMode(*Renderer, SDL_BLENDMODE_NONE);
+	}
+}
+
+// Batched textured quads
+// ----------------------
+// Collects 1:1 blits from a single texture and submits them as one indexed
+// SDL_RenderGeometryRaw() call, in order. Unlike untextured geometry, the
+// vertices must not be offset, as SDL_RenderTexture() doesn't do that either.
+
+class QUAD_BATCH {
+	// Reused across batches to avoid allocating on every frame.
+	std::vector<SDL_FPoint> xys;
+	std::vector<SDL_FPoint> uvs;
+	std::vector<int> indices;
+	SDL_Texture *tex = nullptr;
+	PIXEL_SIZE size = {};
+	float tex_w = 0.0f;
+	float tex_h = 0.0f;
+
+public:
+	bool Begin(SURFACE_ID sid, size_t quads) {
+		size = GrpSurface_Size(sid);
+		tex = Textures[sid];
+		if(!tex || (size.w <= 0) || (size.h <= 0) || (quads == 0)) {
+			return false;
+		}
+		tex_w = static_cast<float>(size.w);
+		tex_h = static_cast<float>(size.h);
+		xys.clear();
+		uvs.clear();
+		indices.clear();
+		xys.reserve(quads * 4);
+		uvs.reserve(quads * 4);
+		indices.reserve(quads * 6);
+		return true;
+	}
+
+	void Add(WINDOW_POINT topleft, PIXEL_LTRB src) {
+		// Like GrpSurface_Blit(), the destination always has the size of the
+		// unclipped [src]. SDL_RenderTexture() clips [src] to the texture and
+		// stretches the remaining part over this destination, skipping empty
+		// and inverted rectangles. We use the same coordinates, but the
+		// renderer might still rasterize geometry slightly differently.
+		const auto l = static_cast<float>(topleft.x);
+		const auto t = static_cast<float>(topleft.y);
+		const auto r = (l + (src.right - src.left));
+		const auto b = (t + (src.bottom - src.top));
+		src.left = (std::max)(src.left, 0);
+		src.top = (std::max)(src.top, 0);
+		src.right = (std::min)(src.right, size.w);
+		src.bottom = (std::min)(src.bottom, size.h);
+		if((src.right <= src.left) || (src.bottom <= src.top)) {
+			return;
+		}
+
+		const auto u_l = (src.left / tex_w);
+		const auto u_r = (src.right / tex_w);
+		const auto v_t = (src.top / tex_h);
+		const auto v_b = (src.bottom / tex_h);
+		const auto first = static_cast<int>(xys.size());
+		xys.insert(xys.end(), { { l, t }, { r, t }, { l, b }, { r, b } });
+		uvs.insert(uvs.end(), {
+			{ u_l, v_t }, { u_r, v_t }, { u_l, v_b }, { u_r, v_b }
+		});
+		indices.insert(indices.end(), {
+			(first + 0), (first + 1), (first + 2),
+			(first + 1), (first + 3), (first + 2),
+		});
+	}
+
+	bool Render(void) {
+		if(xys.empty()) {
+			return false;
+		}
+
+		// SDL_RenderTexture() applies the texture's color and alpha
+		// modulation, SDL_RenderGeometryRaw() only uses the vertex colors.
+		SDL_COLOR col = { 1.0f, 1.0f, 1.0f, 1.0f };
+		SDL_GetTextureColorModFloat(tex, &col.r, &col.g, &col.b);
+		SDL_GetTextureAlphaModFloat(tex, &col.a);
+
+		StatsCountDraw(tex);
+		return SDL_RenderGeometryRaw(
+			*Renderer,
+			tex,
+			&xys[0].x,
+			sizeof(SDL_FPoint),
+			&col,
+			0,
+			&uvs[0].x,
+			sizeof(SDL_FPoint),
+			static_cast<int>(xys.size()),
+			indices.data(),
+			static_cast<int>(indices.size()),
+			sizeof(int)
+		);
+	}
+};
+
+static QUAD_BATCH QuadBatch;
+
+bool GrpSurface_BlitColumns(
+	SURFACE_ID sid,
+	const PIXEL_LTRB& src,
+	std::span<const WINDOW_POINT> columns,
+	PIXEL_COORD column_w
+)
+{
+	assert(columns.size() == static_cast<size_t>(src.right - src.left));
+	if((column_w <= 0) || !QuadBatch.Begin(sid, (columns.size() * column_w))) {
+		return false;
+	}
+
+	// One quad per blit that this call replaces. Stretching a single quad
+	// over all [column_w] pixels would sample across texel boundaries with
+	// linear filtering.
+	PIXEL_LTRB column = { src.left, src.top, (src.left + 1), src.bottom };
+	for(const auto& topleft : columns) {
+		for(PIXEL_COORD k = 0; k < column_w; k++) {
+			QuadBatch.Add({ (topleft.x + k), topleft.y }, column);
+		}
+		column.left++;
+		column.right++;
+	}
+	return QuadBatch.Render();
+}
+
+bool GrpSurface_BlitBatch(SURFACE_ID sid, std::span<const GRP_SPRITE> sprites)
+{
+	if(!QuadBatch.Begin(sid, sprites.size())) {
+		return false;
+	}
+	for(const auto& sprite : sprites) {
+		QuadBatch.Add(sprite.topleft, sprite.src);
+	}
+	return QuadBatch.Render();
+}
+// ----------------------
+
+bool GrpSurface_SetBrightness(SURFACE_ID sid, uint16_t brightness)
+{
+	auto *tex = Textures[sid];
+	if(!tex || (brightness > BRIGHTNESS_WHITE)) {
+		return false;
+	}
+	const auto mod = Cast::down<uint8_t>(
+		(std::min)(brightness, BRIGHTNESS_NORMAL)
+	);
+	Whiten[sid] = Cast::down_sign<uint8_t>(brightness - mod);
+	return SDL_SetTextureColorMod(tex, mod, mod, mod);
+}
+
+void GrpSurface_SetPaletteRange(SURFACE_ID, uint8_t, uint8_t)
+{
 }
 
 #ifdef WIN32
@@ -1160,6 +1370,7 @@ void DrawGeometry(
 		*(sdl++) = { .x = (game.x + offset_x), .y = (game.y + offset_y) };
 	}
 
+	StatsCountDraw(nullptr);
 	SDL_RenderGeometryRaw(
 		*Renderer,
 		nullptr,
@@ -1218,6 +1429,7 @@ void GRAPHICS_GEOMETRY_SDL::SetAlphaOne(void)
 
 void GRAPHICS_GEOMETRY_SDL::DrawLine(int x1, int y1, int x2, int y2)
 {
+	StatsCountDraw(nullptr);
 	SDL_RenderLine(*Renderer, x1, y1, x2, y2);
 }
 
@@ -1229,6 +1441,7 @@ void GRAPHICS_GEOMETRY_SDL::DrawBox(int x1, int y1, int x2, int y2)
 		.w = static_cast<float>(x2 - x1),
 		.h = static_cast<float>(y2 - y1),
 	};
+	StatsCountDraw(nullptr);
 	SDL_RenderFillRect(*Renderer, &rect);
 }
 
@@ -1245,6 +1458,7 @@ void GRAPHICS_GEOMETRY_SDL::DrawTriangleFan(VERTEX_XY_SPAN<> xys)
 void GRAPHICS_GEOMETRY_SDL::DrawLineStrip(VERTEX_XY_SPAN<> xys)
 {
 	const auto points = HelpFPointsFrom(xys);
+	StatsCountDraw(nullptr);
 	SDL_RenderLines(*Renderer, points.data(), points.size());
 }
 
@@ -6,6 +6,7 @@
 // SDL headers must come first to avoid import→#include bugs on Clang 19.
 #include <SDL3/SDL_events.h>
 #include <SDL3/SDL_joystick.h>
+#include <SDL3/SDL_timer.h>
 
 #include "platform/input.h"
 #include "game/defer.h"
@@ -91,17 +92,23 @@ static constexpr std::pair<KEY_BIND, INPUT_SYSTEM_BITS> SystemKeyBindings[] = {
 	{ { SDL_SCANCODE_RETURN, KEY_MOD::LALT }, SYSKEY_GRP_FULLSCREEN },
 };
 
+// [latched] collects all bits that were pressed at any point during the
+// current Key_Read() call, which lets taps shorter than a frame survive a
+// release event that follows within the same call.
 template <class Bits> void Key_Flip(
-	Bits& key_data, const auto& key_or_jbutton, Bits bits
+	Bits& key_data, Bits& latched, const auto& key_or_jbutton, Bits bits
 )
 {
 	if(key_or_jbutton.down) {
 		key_data |= bits;
+		latched |= bits;
 	} else {
 		key_data &= ~bits;
 	}
 }
 
+static INPUT_AGE_STATS AgeTotal;
+
 struct JOYPAD {
 	SDL_Joystick* joystick;
 	uint8_t axis_x;
@@ -200,11 +207,32 @@ void Key_End(void)
 void Key_Read(void)
 {
 	static INPUT_BITS Key_Data_Real = 0;
+	INPUT_BITS key_latched = 0;
+	INPUT_BITS pad_latched = 0;
+	INPUT_SYSTEM_BITS system_latched = 0;
+
+	// System keys whose press and release both happened during the previous
+	// call. [SystemKey_Data] persists across calls because consumers clear
+	// bits in it to only react once, so these must be removed explicitly.
+	static INPUT_SYSTEM_BITS system_tapped = 0;
+	SystemKey_Data &= ~std::exchange(system_tapped, 0);
+
+	const auto now_ns = SDL_GetTicksNS();
 
 	SDL_Event event;
 	while(SDL_PeepEvents(
 		&event, 1, SDL_GETEVENT, SDL_EVENT_KEY_DOWN, SDL_EVENT_JOYSTICK_REMOVED
 	) == 1) {
+		// SDL 3 stamps every event with the OS event time on the same clock
+		// as SDL_GetTicksNS() where available, and the time of queueing
+		// otherwise.
+		const auto age_ns = (
+			(now_ns > event.common.timestamp)
+				? (now_ns - event.common.timestamp)
+				: 0
+		);
+		AgeTotal.Add(age_ns);
+
 		switch(event.type) {
 		case SDL_EVENT_JOYSTICK_AXIS_MOTION: {
 			auto& pad = *Pad_Find(event.jaxis.which);
@@ -222,6 +250,7 @@ void Key_Read(void)
 				Pad_Data &= ~(KEY_UP | KEY_DOWN);
 				Pad_Data |= ((v <= -4) ? KEY_UP : ((v >= 4) ? KEY_DOWN : 0));
 			}
+			pad_latched |= Pad_Data;
 			break;
 		}
 
@@ -231,7 +260,9 @@ void Key_Read(void)
 			const INPUT_PAD_BUTTON id = (event.jbutton.button + 1);
 			for(const auto& binding : Key_PadBindings) {
 				if(id == binding.first) {
-					Key_Flip(Pad_Data, event.jbutton, binding.second);
+					Key_Flip(
+						Pad_Data, pad_latched, event.jbutton, binding.second
+					);
 				}
 			}
 
@@ -260,12 +291,19 @@ void Key_Read(void)
 			};
 			for(const auto& binding : KeyBindings) {
 				if(binding.first.Matches(scancode)) {
-					Key_Flip(Key_Data_Real, event.key, binding.second);
+					Key_Flip(
+						Key_Data_Real, key_latched, event.key, binding.second
+					);
 				}
 			}
 			for(const auto& binding : SystemKeyBindings) {
 				if(binding.first.Matches(scancode)) {
-					Key_Flip(SystemKey_Data, event.key, binding.second);
+					Key_Flip(
+						SystemKey_Data,
+						system_latched,
+						event.key,
+						binding.second
+					);
 				}
 			}
 			break;
@@ -299,7 +337,14 @@ void Key_Read(void)
 			break;
 		}
 	}
-	Key_Data = (Key_Data_Real | Pad_Data);
+	Key_Data = (Key_Data_Real | key_latched | Pad_Data | pad_latched);
+	system_tapped = (system_latched & ~SystemKey_Data);
+	SystemKey_Data |= system_tapped;
+}
+
+INPUT_AGE_STATS Key_AgeStatsTake(void)
+{
+	return std::exchange(AgeTotal, {});
 }
 
 std::optional<INPUT_PAD_BUTTON> Key_PadSingle(void)
@@ -22,7 +22,15 @@ void SndBackend_BGMUpdateVolume(void);
 namespace BGM {
 	struct TRACK;
 }
-bool SndBackend_BGMLoad(std::shared_ptr<BGM::TRACK> track);
+
+// Loads [track] for playback via SndBackend_BGMPlay(). If [crossfade] is
+// nonzero and another track is currently playing, that track keeps playing
+// and fades out over [crossfade] once the new track starts, while the new
+// track fades in over the same duration, starting on the same sample.
+bool SndBackend_BGMLoad(
+	std::shared_ptr<BGM::TRACK> track,
+	std::chrono::milliseconds crossfade = std::chrono::milliseconds::zero()
+);
 void SndBackend_BGMPlay(void);
 void SndBackend_BGMStop(void);
 
@@ -53,3 +61,10 @@ void SndBackend_SEStop(uint8_t id);
 // Pause or resume all playing sounds if the window loses focus
 void SndBackend_PauseAll();
 void SndBackend_ResumeAll();
+
+// Offline rendering. Only called after SndBackend_Init(). While active, the
+// backend must not mix to the audio device, and won't receive any
+// SndBackend_PauseAll() or SndBackend_ResumeAll() calls.
+std::optional<SND_OFFLINE_FORMAT> SndBackend_OfflineStart(void);
+void SndBackend_OfflineRender(std::span<float> out);
+void SndBackend_OfflineEnd(void);
@@ -19,3 +19,6 @@ uint32_t Time_SteadyTicksMS();
 
 // Returns the current local system time.
 TIME_OF_DAY Time_NowLocal();
+
+// Returns the current system time as seconds since the Unix epoch, in UTC.
+int64_t Time_NowUnix();
@@ -71,3 +71,41 @@ bool File_CloseWithTimestamps(
 	maybe_timestamps.reset();
 	return SDL_CloseIO(context);
 }
+
+bool File_IsReadOnly(const char8_t *fn)
+{
+	return UTF::WithUTF16<bool>(fn, [](const std::wstring_view fn_w) {
+		const auto attrib = GetFileAttributesW(fn_w.data());
+		return (
+			(attrib != INVALID_FILE_ATTRIBUTES) &&
+			(attrib & FILE_ATTRIBUTE_READONLY)
+		);
+	}).value_or(false);
+}
+
+bool File_Sync(SDL_IOStream *context)
+{
+	if(!SDL_FlushIO(context)) {
+		return false;
+	}
+	const SDL_PropertiesID props = SDL_GetIOProperties(context);
+	auto handle = std::bit_cast<HANDLE>(SDL_GetPointerProperty(
+		props, SDL_PROP_IOSTREAM_WINDOWS_HANDLE_POINTER, INVALID_HANDLE_VALUE
+	));
+	return (
+		(handle != INVALID_HANDLE_VALUE) && (FlushFileBuffers(handle) != 0)
+	);
+}
+
+bool File_RenameReplace(const char8_t *src, const char8_t *dst)
+{
+	return UTF::WithUTF16<bool>(src, [dst](const std::wstring_view src_w) {
+		return UTF::WithUTF16<bool>(dst, [&](const std::wstring_view dst_w) {
+			return (MoveFileExW(
+				src_w.data(),
+				dst_w.data(),
+				(MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)
+			) != 0);
+		}).value_or(false);
+	}).value_or(false);
+}
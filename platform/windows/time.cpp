@@ -27,3 +27,13 @@ TIME_OF_DAY Time_NowLocal()
 		.second = Cast::down<uint8_t>(systime.wSecond),
 	};
 }
+
+int64_t Time_NowUnix()
+{
+	// FILETIME counts 100 ns intervals since 1601-01-01.
+	constexpr int64_t UNIX_EPOCH_FILETIME = 116444736000000000;
+	FILETIME ft;
+	GetSystemTimeAsFileTime(&ft);
+	const auto t = ((int64_t{ ft.dwHighDateTime } << 32) | ft.dwLowDateTime);
+	return ((t - UNIX_EPOCH_FILETIME) / 10'000'000);
+}
@@ -0,0 +1,268 @@
+/*
+ *   Tests for non-blocking BGM pack switches
+ *
+ */
+
+#include <SDL3/SDL_filesystem.h>
+#include <SDL3/SDL_iostream.h>
+
+#include "test/test.h"
+#include "game/bgm.h"
+#include "game/bgm_track.h"
+#include "game/defer.h"
+#include "game/narrow.h"
+#include "game/snd.h"
+#include "game/string_format.h"
+#include "platform/file.h"
+#include "platform/path.h"
+
+using namespace std::chrono_literals;
+
+static constexpr std::u8string_view BGM_ROOT = u8"bgm/";
+static constexpr std::u8string_view PACK = u8"__test_switch";
+static constexpr unsigned int TRACK_COUNT = 3;
+static constexpr auto FRAME = std::chrono::microseconds(1'000'000 / 60);
+
+// Generated FLAC tracks
+// ---------------------
+
+static constexpr uint32_t RATE = 44100;
+static constexpr uint16_t BLOCK_SIZE = 4096;
+static constexpr uint8_t FRAME_COUNT = 64; // Encoded as a single UTF-8 byte
+
+static void PutBE(std::vector<uint8_t>& out, uint64_t v, unsigned int bytes)
+{
+	while(bytes-- > 0) {
+		out.emplace_back(static_cast<uint8_t>(v >> (bytes * 8)));
+	}
+}
+
+static void PutLE32(std::vector<uint8_t>& out, uint32_t v)
+{
+	for(unsigned int i = 0; i < 4; i++) {
+		out.emplace_back(static_cast<uint8_t>(v >> (i * 8)));
+	}
+}
+
+static uint8_t CRC8(std::span<const uint8_t> data)
+{
+	uint8_t ret = 0;
+	for(const auto byte : data) {
+		ret ^= byte;
+		for(unsigned int bit = 0; bit < 8; bit++) {
+			ret = ((ret & 0x80) ? ((ret << 1) ^ 0x07) : (ret << 1));
+		}
+	}
+	return ret;
+}
+
+static uint16_t CRC16(std::span<const uint8_t> data)
+{
+	uint16_t ret = 0;
+	for(const auto byte : data) {
+		ret ^= (byte << 8);
+		for(unsigned int bit = 0; bit < 8; bit++) {
+			ret = ((ret & 0x8000) ? ((ret << 1) ^ 0x8005) : (ret << 1));
+		}
+	}
+	return ret;
+}
+
+// Encodes a stereo 16-bit FLAC file with verbatim subframes and the given
+// title.
+static std::vector<uint8_t> FLACTrack(
+	unsigned int seed, const std::u8string_view title
+)
+{
+	std::vector<uint8_t> ret = { 'f', 'L', 'a', 'C' };
+
+	// STREAMINFO
+	const uint64_t samples = (BLOCK_SIZE * FRAME_COUNT);
+	PutBE(ret, 0x00'000022, 4);
+	PutBE(ret, BLOCK_SIZE, 2);
+	PutBE(ret, BLOCK_SIZE, 2);
+	PutBE(ret, 0, 3);
+	PutBE(ret, 0, 3);
+	PutBE(ret, (
+		(uint64_t{ RATE } << 44) | // Sampling rate
+		(1ull << 41) | // 2 channels
+		(15ull << 36) | // 16 bits per sample
+		samples
+	), 8);
+	ret.insert(ret.end(), 16, 0); // MD5 (unknown)
+
+	// VORBIS_COMMENT, as the last metadata block
+	const auto comment = (std::u8string{ u8"TITLE=" } + std::u8string{ title });
+	PutBE(ret, ((0x84ull << 24) | (4 + 4 + 4 + comment.size())), 4);
+	PutLE32(ret, 0);
+	PutLE32(ret, 1);
+	PutLE32(ret, comment.size());
+	ret.insert(ret.end(), comment.begin(), comment.end());
+
+	uint32_t sample_i = 0;
+	for(uint8_t frame = 0; frame < FRAME_COUNT; frame++) {
+		const auto frame_start = ret.size();
+		ret.insert(ret.end(), {
+			0xFF, 0xF8, // Sync code, fixed block size
+			0xC9, // 4096 samples, 44.1 kHz
+			0x18, // Independent stereo, 16 bits per sample
+			frame,
+		});
+		ret.emplace_back(CRC8(std::span(ret).subspan(frame_start)));
+		for(unsigned int channel = 0; channel < 2; channel++) {
+			ret.emplace_back(0x02); // Verbatim subframe
+			for(uint16_t i = 0; i < BLOCK_SIZE; i++) {
+				const auto t = ((sample_i + i) * (seed + channel + 1) * 37);
+				PutBE(ret, static_cast<uint16_t>((t & 0x3FFF) - 0x2000), 2);
+			}
+		}
+		sample_i += BLOCK_SIZE;
+		PutBE(ret, CRC16(std::span(ret).subspan(frame_start)), 2);
+	}
+	return ret;
+}
+
+static std::u8string TrackTitle(unsigned int id)
+{
+	std::u8string ret = u8"Switch test track ";
+	return StringCatNum<0>((id + 1), ret);
+}
+// ---------------------
+
+// Test pack in the data directory, where BGM_PackSet() looks for packs
+// -----------------------------------------------------------------------
+
+static std::u8string PackDir(void)
+{
+	std::u8string ret{ PathForData() };
+	ret += BGM_ROOT;
+	ret += PACK;
+	ret += '/';
+	return ret;
+}
+
+static std::u8string PackTrackFN(unsigned int id)
+{
+	auto ret = PackDir();
+	return StringCatNum<2>((id + 1), ret);
+}
+
+static bool PackCreate(void)
+{
+	if(!SDL_CreateDirectory(PackDir().c_str())) {
+		return false;
+	}
+	for(unsigned int id = 0; id < TRACK_COUNT; id++) {
+		const auto fn = (PackTrackFN(id) + u8".flac");
+		const auto flac = FLACTrack(id, TrackTitle(id));
+		if(!SDL_SaveFile(fn.c_str(), flac.data(), flac.size())) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static void PackRemove(void)
+{
+	for(unsigned int id = 0; id < TRACK_COUNT; id++) {
+		const auto fn = (PackTrackFN(id) + u8".flac");
+		SDL_RemovePath(std::bit_cast<const char *>(fn.c_str()));
+	}
+	SDL_RemovePath(std::bit_cast<const char *>(PackDir().c_str()));
+
+	// Only succeeds if the directory is empty, i.e., if we created it.
+	std::u8string root{ PathForData() };
+	root += BGM_ROOT;
+	SDL_RemovePath(std::bit_cast<const char *>(root.c_str()));
+}
+// -----------------------------------------------------------------------
+
+static const TEST BGM_SWITCH_MAIN_THREAD = { "bgm/switch/main_thread", [] {
+	// Waveform tracks are mixed by the sound backend whether or not a device
+	// is open, and CI machines might not have one.
+	Snd_Offline = true;
+	defer(Snd_Offline = false);
+
+	const bool created = PackCreate();
+	if(!TEST_CHECK(created) || !TEST_CHECK(BGM_Init())) {
+		PackRemove();
+		return;
+	}
+
+	// Synchronous reference, as BGM_Switch() used to do on the main thread.
+	const auto sync_start = std::chrono::steady_clock::now();
+	if(const auto track = BGM::TrackOpen(PackTrackFN(0))) {
+		track->Prefetch(250ms);
+	}
+	const auto sync_time = (std::chrono::steady_clock::now() - sync_start);
+
+	TEST_CHECK(BGM_PackSet(PACK));
+
+	std::chrono::steady_clock::duration worst{};
+	const auto timed = [&](auto&& func) {
+		const auto start = std::chrono::steady_clock::now();
+		func();
+		worst = (std::max)(worst, (std::chrono::steady_clock::now() - start));
+	};
+
+	// Runs frames like GameFrame() until all pending work is done.
+	const auto run_frames = [&](unsigned int min_frames) {
+		for(unsigned int i = 0; i < 600; i++) {
+			timed([] { BGM_Update(); });
+			if((i >= min_frames) && !BGM_SwitchPending()) {
+				return;
+			}
+			std::this_thread::sleep_for(FRAME);
+		}
+	};
+	const auto title_is = [](unsigned int id) {
+		const auto title = TrackTitle(id);
+		return (BGM_Title() == Narrow::string_view(title));
+	};
+
+	// Cold switch to a track that was never prefetched
+	timed([] { BGM_Switch(0); });
+	run_frames(0);
+	TEST_CHECK(BGM_Playing() == BGM_PLAYING::WAVEFORM);
+	TEST_CHECK(title_is(0));
+
+	// Prefetched switch
+	timed([] { BGM_Prefetch(1); });
+	run_frames(30);
+	timed([] { BGM_Switch(1); });
+	run_frames(0);
+	TEST_CHECK(title_is(1));
+
+	// A crossfading switch queued behind a different prefetch must not be
+	// replaced by a later prefetch request.
+	timed([] { BGM_Prefetch(2); });
+	timed([] { BGM_Switch(0, 100ms); });
+	timed([] { BGM_Prefetch(1); });
+	run_frames(0);
+	TEST_CHECK(title_is(0));
+	TEST_CHECK(BGM_Playing() == BGM_PLAYING::WAVEFORM);
+
+	// Stopping cancels a pending switch.
+	timed([] { BGM_Switch(2); });
+	timed(BGM_Stop);
+	run_frames(30);
+	TEST_CHECK(BGM_Playing() == BGM_PLAYING::NONE);
+
+	TEST_CHECK(worst < FRAME);
+	printf(
+		"Worst main-thread time: %lld us (synchronous open: %lld us)\n",
+		static_cast<long long>(
+			std::chrono::duration_cast<std::chrono::microseconds>(worst).count()
+		),
+		static_cast<long long>(
+			std::chrono::duration_cast<std::chrono::microseconds>(
+				sync_time
+			).count()
+		)
+	);
+
+	// Switching to the empty pack with BGM stopped doesn't load any MIDI.
+	BGM_PackSet(u8"");
+	BGM_Cleanup();
+	PackRemove();
+} };
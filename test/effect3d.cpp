@@ -0,0 +1,153 @@
+/*
+ *   Tests for the 3D effects
+ *
+ */
+
+#include "test/test.h"
+#include "test/graphics.h"
+#include "GIAN07/EFFECT3D.H"
+#include "game/defer.h"
+#include "game/sprite_batch.h"
+#include "game/ut_math.h"
+
+// The original per-point rotation that ROTATION3D replaced.
+static Point3D Transform3DReference(
+	Point3D p, uint8_t dx, uint8_t dy, uint8_t dz
+)
+{
+	Point3D temp;
+
+	temp.y = p.y;
+	temp.z = p.z;
+	p.y = (cosl(dx, temp.y) - sinl(dx, temp.z));
+	p.z = (sinl(dx, temp.y) + cosl(dx, temp.z));
+
+	temp.x = p.x;
+	temp.z = p.z;
+	p.x = ( cosl(dy, temp.x) + sinl(dy, temp.z));
+	p.z = (-sinl(dy, temp.x) + cosl(dy, temp.z));
+
+	temp.x = p.x;
+	temp.y = p.y;
+	p.x = (cosl(dz, temp.x) - sinl(dz, temp.y));
+	p.y = (sinl(dz, temp.x) + cosl(dz, temp.y));
+	return p;
+}
+
+static const TEST Rotation3DExhaustive = { "effect3d/rotation3d", [] {
+	static constexpr Point3D POINTS[] = {
+		{ 0, 0, 0 },
+		{ 64, 0, 0 },
+		{ 0, -64, 0 },
+		{ 0, 0, 64 },
+		{ (15 * 64), -(15 * 64), (15 * 64) },
+		{ -12345, 6789, -31415 },
+		{ (1 << 20), -(1 << 20), (1 << 19) },
+	};
+
+	// Every angle triple, split by the X angle.
+	const auto failures = Test_ParallelCountFailures(0, 255, [](int64_t v) {
+		const auto dx = static_cast<uint8_t>(v);
+		bool ret = true;
+		for(unsigned int dy = 0; dy < 256; dy++) {
+			for(unsigned int dz = 0; dz < 256; dz++) {
+				const ROTATION3D rot(dx, dy, dz);
+				for(const auto& p : POINTS) {
+					const auto expected = Transform3DReference(p, dx, dy, dz);
+					const auto actual = rot(p);
+					ret &= (
+						(actual.x == expected.x) &&
+						(actual.y == expected.y) &&
+						(actual.z == expected.z)
+					);
+				}
+			}
+		}
+		return ret;
+	});
+	TEST_CHECK(failures == 0);
+} };
+
+// Counts the draw calls and state changes per frame of the sprite-based stage
+// background effects on the SDL backend, both with their sprite batches and
+// with every sprite blitted individually like in the original game, and
+// prints them together with the time per frame on the software renderer.
+static const TEST BatchBenchmark = { "effect3d/batch/benchmark", [] {
+	using namespace std::chrono;
+
+	constexpr int FRAMES = 60;
+	constexpr PIXEL_SIZE SHEET_SIZE = { 640, 480 };
+
+	if(!TEST_CHECK(TestGrp_Init())) {
+		return;
+	}
+	defer(TestGrp_Cleanup());
+	defer(SPRITE_BATCH::Unbatched = false);
+	if(
+		!TEST_CHECK(TestGrp_SurfaceRandom(SURFACE_ID::SYSTEM, SHEET_SIZE, 1)) ||
+		!TEST_CHECK(TestGrp_SurfaceRandom(SURFACE_ID::MAPCHIP, SHEET_SIZE, 2))
+	) {
+		return;
+	}
+
+	struct EFFECT {
+		const char *name;
+		void (*init)(void);
+		void (*move)(void);
+		void (*draw)(void);
+	};
+	static constexpr EFFECT EFFECTS[] = {
+		{ "Stage 3 stars", InitStg3Star, MoveStg3Star, DrawStg3Star },
+		{ "Stage 4 rocks", InitStg4Rock, MoveStg4Rock, DrawStg4Rock },
+		{ "Stage 6 raster", InitStg6Raster, MoveStg6Raster, DrawStg6Raster },
+		{ "3D cube", Init3DCube, Move3DCube, Draw3DCube },
+	};
+
+	struct RESULT {
+		GRAPHICS_STATS stats;
+		microseconds time;
+	};
+	const auto run = [](const EFFECT& effect, bool unbatched) {
+		SPRITE_BATCH::Unbatched = unbatched;
+		rnd_seed_set(0x5B47);
+		effect.init();
+		GrpBackend_Clear();
+		GrpBackend_StatsTake();
+		const auto start = steady_clock::now();
+		for(int frame = 0; frame < FRAMES; frame++) {
+			effect.move();
+			effect.draw();
+
+			// Locking the backbuffer waits for the renderer.
+			GrpBackend_PixelAccessLock();
+			GrpBackend_PixelAccessUnlock();
+		}
+		const auto time = (steady_clock::now() - start);
+		const auto stats = GrpBackend_StatsTake();
+		return RESULT{
+			.stats = {
+				.draw_calls = (stats.draw_calls / FRAMES),
+				.state_changes = (stats.state_changes / FRAMES),
+			},
+			.time = duration_cast<microseconds>(time / FRAMES),
+		};
+	};
+
+	printf("Per frame: draw calls / state changes / time\n");
+	for(const auto& effect : EFFECTS) {
+		const auto before = run(effect, true);
+		const auto after = run(effect, false);
+		TEST_CHECK(after.stats.draw_calls <= before.stats.draw_calls);
+		printf(
+			"%-14s: %5u / %5u / %6lld us (per sprite), "
+			"%5u / %5u / %6lld us (batched)\n",
+			effect.name,
+			before.stats.draw_calls,
+			before.stats.state_changes,
+			static_cast<long long>(before.time.count()),
+			after.stats.draw_calls,
+			after.stats.state_changes,
+			static_cast<long long>(after.time.count())
+		);
+	}
+}, true };
@@ -0,0 +1,202 @@
+/*
+ *   Tests for the generic entity management
+ *
+ */
+
+#include "test/test.h"
+#include "game/defer.h"
+#include "GIAN07/entity.h"
+
+// Applies the same random spawns and despawns to an ENTITY_ACTIVE_SET and a
+// plain bool array, which serves as the reference.
+struct ACTIVE_SET_FIXTURE {
+	ENTITY_ACTIVE_SET set;
+	std::vector<bool> ref;
+	std::mt19937 rng;
+
+	ACTIVE_SET_FIXTURE(size_t capacity, uint32_t seed) :
+		ref(capacity, false), rng(seed) {
+		set.Allocate(capacity);
+	}
+
+	// Toggles random slots until roughly [fill] of all slots are active.
+	void Randomize(double fill) {
+		std::bernoulli_distribution active{ fill };
+		for(size_t i = 0; i < ref.size(); i++) {
+			ref[i] = active(rng);
+			set.Set(i, ref[i]);
+		}
+	}
+
+	std::optional<size_t> FirstFreeReference(size_t from) const {
+		for(auto i = from; i < ref.size(); i++) {
+			if(!ref[i]) {
+				return i;
+			}
+		}
+		return std::nullopt;
+	}
+
+	std::vector<size_t> ActiveReference(void) const {
+		std::vector<size_t> ret;
+		for(size_t i = 0; i < ref.size(); i++) {
+			if(ref[i]) {
+				ret.emplace_back(i);
+			}
+		}
+		return ret;
+	}
+};
+
+// Capacities around the 64-bit word boundaries
+constexpr size_t CAPACITIES[] = { 1, 2, 63, 64, 65, 127, 128, 129, 1000 };
+constexpr double FILLS[] = { 0.0, 0.05, 0.5, 0.95, 1.0 };
+
+static const TEST ActiveSetFirstFree = { "entity/active_set/first_free", [] {
+	for(const auto capacity : CAPACITIES) {
+		for(const auto fill : FILLS) {
+			ACTIVE_SET_FIXTURE f = { capacity, uint32_t(capacity) };
+			for(int round = 0; round < 16; round++) {
+				f.Randomize(fill);
+				for(size_t from = 0; from <= (capacity + 64); from++) {
+					const auto expected = f.FirstFreeReference(from);
+					TEST_CHECK(f.set.FirstFree(from) == expected);
+				}
+				for(size_t i = 0; i < capacity; i++) {
+					TEST_CHECK(f.set.Test(i) == f.ref[i]);
+				}
+			}
+		}
+	}
+} };
+
+static const TEST ActiveSetForEach = { "entity/active_set/for_each", [] {
+	for(const auto capacity : CAPACITIES) {
+		for(const auto fill : FILLS) {
+			ACTIVE_SET_FIXTURE f = { capacity, uint32_t(capacity) };
+			for(int round = 0; round < 16; round++) {
+				f.Randomize(fill);
+				std::vector<size_t> visited;
+				f.set.ForEach([&](size_t i) {
+					visited.emplace_back(i);
+				});
+				TEST_CHECK(visited == f.ActiveReference());
+
+				// Despawning the visited slot must neither skip nor repeat
+				// any of the others.
+				const auto active_before = f.ActiveReference();
+				visited.clear();
+				f.set.ForEach([&](size_t i) {
+					visited.emplace_back(i);
+					if((i % 2) == 0) {
+						f.set.Set(i, false);
+						f.ref[i] = false;
+					}
+				});
+				TEST_CHECK(visited == active_before);
+				visited.clear();
+				f.set.ForEach([&](size_t i) {
+					visited.emplace_back(i);
+				});
+				TEST_CHECK(visited == f.ActiveReference());
+			}
+		}
+	}
+} };
+
+// Compares spawning into and iterating over a sparsely populated set against
+// the linear scans over the whole array that ENTITY_ACTIVE_SET replaced.
+static const TEST ActiveSetBenchmark = { "entity/active_set/benchmark", [] {
+	using namespace std::chrono;
+
+	constexpr size_t CAPACITY = 4096;
+	constexpr int ROUNDS = 2000;
+	for(const auto fill : { 0.05, 0.5, 0.95 }) {
+		ACTIVE_SET_FIXTURE f = { CAPACITY, 0 };
+		f.Randomize(fill);
+
+		// Like the `flag` members of the original entity structures
+		const std::vector<uint8_t> flags(f.ref.begin(), f.ref.end());
+
+		size_t sum_set = 0;
+		const auto t_set_start = steady_clock::now();
+		for(int round = 0; round < ROUNDS; round++) {
+			f.set.ForEach([&](size_t i) {
+				sum_set += i;
+			});
+			sum_set += f.set.FirstFree().value_or(0);
+		}
+		const auto t_set = (steady_clock::now() - t_set_start);
+
+		size_t sum_ref = 0;
+		const auto t_ref_start = steady_clock::now();
+		for(int round = 0; round < ROUNDS; round++) {
+			for(size_t i = 0; i < CAPACITY; i++) {
+				sum_ref += (flags[i] ? i : 0);
+			}
+			const auto free = std::ranges::find(flags, 0);
+			if(free != flags.end()) {
+				sum_ref += static_cast<size_t>(free - flags.begin());
+			}
+		}
+		const auto t_ref = (steady_clock::now() - t_ref_start);
+
+		TEST_CHECK(sum_set == sum_ref);
+		printf(
+			"%3.0f%% active: %lld us (set) / %lld us (linear scan)\n",
+			(fill * 100),
+			static_cast<long long>(duration_cast<microseconds>(t_set).count()),
+			static_cast<long long>(duration_cast<microseconds>(t_ref).count())
+		);
+	}
+}, true };
+
+// Capacity overrides
+// ------------------
+// Uses its own pool, so that the game's pools keep their default capacities
+// for all other tests.
+
+static ENTITY_POOL TestPool = { u8"test", 100, [](uint16_t) {} };
+
+static const TEST CapacitySpecs = { "entity/capacity/specs", [] {
+	// Without any overrides, replays store no specs, and only match an empty
+	// list.
+	TEST_CHECK(Entity_CapacitySpecs().empty());
+	TEST_CHECK(Entity_CapacitySpecsMatch(u8""));
+
+	for(const auto spec : {
+		u8"test", u8"test=", u8"=100", u8"tset=100", u8"test=-5", u8"test=1",
+		u8"test=0x10", u8"test=12x", u8"test=65536",
+	}) {
+		TEST_CHECK(!Entity_SetCapacity(spec));
+	}
+	TEST_CHECK(TestPool.capacity == TestPool.capacity_default);
+
+	defer(TestPool.capacity = TestPool.capacity_default);
+	TEST_CHECK(Entity_SetCapacity(u8"test=2"));
+	TEST_CHECK(Entity_SetCapacity(u8"test=1000"));
+	TEST_CHECK(TestPool.capacity == 1000);
+
+	const auto specs = Entity_CapacitySpecs();
+	TEST_CHECK(specs == u8"test=1000\n");
+	TEST_CHECK(Entity_CapacitySpecsMatch(specs));
+	TEST_CHECK(Entity_CapacitySpecsMatch(u8"\ntest=1000"));
+	TEST_CHECK(!Entity_CapacitySpecsMatch(u8""));
+	TEST_CHECK(!Entity_CapacitySpecsMatch(u8"test=999\n"));
+	TEST_CHECK(!Entity_CapacitySpecsMatch(u8"test=1000\ntset=1000\n"));
+
+	// Spelling out a default capacity is the same as not overriding it.
+	TEST_CHECK(Entity_SetCapacity(u8"test=100"));
+	TEST_CHECK(Entity_CapacitySpecs().empty());
+	TEST_CHECK(Entity_CapacitySpecsMatch(u8"test=100\n"));
+	TEST_CHECK(Entity_CapacitySpecsMatch(u8""));
+} };
+
+static const TEST HighWater = { "entity/capacity/high_water", [] {
+	defer(TestPool.high_water = 0);
+	TestPool.high_water = 0;
+	for(const auto active : { 3u, 7u, 5u, 0u, 7u }) {
+		TestPool.Track(active);
+	}
+	TEST_CHECK(TestPool.high_water == 7);
+} };
@@ -0,0 +1,140 @@
+/*
+ *   Tests for brightness fades across bit depths
+ *
+ */
+
+#include <SDL3/SDL_render.h>
+#include <SDL3/SDL_surface.h>
+
+#include "test/test.h"
+#include "game/defer.h"
+#include "game/graphics.h"
+
+// One pixel for each palette color.
+static constexpr PIXEL_SIZE SIZE = { 16, 16 };
+
+// Copies [surf] into a tightly packed XRGB8888 pixel buffer.
+static std::vector<uint32_t> Pixels(SDL_Surface *surf)
+{
+	auto *xrgb = SDL_ConvertSurface(surf, SDL_PIXELFORMAT_XRGB8888);
+	if(!xrgb) {
+		return {};
+	}
+	defer(SDL_DestroySurface(xrgb));
+	std::vector<uint32_t> ret;
+	ret.reserve(SIZE.w * SIZE.h);
+	const auto *row = static_cast<const std::byte *>(xrgb->pixels);
+	for(const auto y : std::views::iota(0, SIZE.h)) {
+		const auto *p = std::bit_cast<const uint32_t *>(row);
+		for(const auto x : std::views::iota(0, SIZE.w)) {
+			ret.emplace_back(p[x] & 0xFFFFFF);
+		}
+		row += xrgb->pitch;
+	}
+	return ret;
+}
+
+// Fades a palettized surface at every brightness level the way the
+// DirectDraw backend does in 8-bit mode, and compares each "screenshot" with
+// the one rendered from the same pixels by the SDL backend's method: Color
+// modulation for darkening, and a white box blended over opaque blits for
+// brightening. The software renderer gives us SDL's exact rounding without
+// requiring a GPU or a window.
+static const TEST FadeDepths = { "graphics/fade/depths", [] {
+	PALETTE pal;
+	std::mt19937 rng{ 0x5347 };
+	for(auto& col : pal) {
+		const auto v = rng();
+		col = RGBA{
+			.r = static_cast<uint8_t>(v),
+			.g = static_cast<uint8_t>(v >> 8),
+			.b = static_cast<uint8_t>(v >> 16),
+		};
+	}
+	pal[0] = { 0x00, 0x00, 0x00 };
+	pal[1] = { 0xFF, 0xFF, 0xFF };
+
+	auto *indexed = SDL_CreateSurface(SIZE.w, SIZE.h, SDL_PIXELFORMAT_INDEX8);
+	auto *target = SDL_CreateSurface(SIZE.w, SIZE.h, SDL_PIXELFORMAT_XRGB8888);
+	defer(SDL_DestroySurface(target));
+	defer(SDL_DestroySurface(indexed));
+	if(!TEST_CHECK(indexed && target)) {
+		return;
+	}
+	auto *palette = SDL_CreateSurfacePalette(indexed);
+	if(!TEST_CHECK(palette != nullptr)) {
+		return;
+	}
+	auto *row = static_cast<uint8_t *>(indexed->pixels);
+	for(const auto y : std::views::iota(0, SIZE.h)) {
+		for(const auto x : std::views::iota(0, SIZE.w)) {
+			row[x] = static_cast<uint8_t>((y * SIZE.w) + x);
+		}
+		row += indexed->pitch;
+	}
+	const auto set_palette = [&](const PALETTE& pal) {
+		std::array<SDL_Color, PALETTE{}.size()> colors;
+		std::ranges::transform(pal, colors.begin(), [](const RGBA& col) {
+			return SDL_Color{ col.r, col.g, col.b, 0xFF };
+		});
+		return SDL_SetPaletteColors(
+			palette, colors.data(), 0, static_cast<int>(colors.size())
+		);
+	};
+
+	// The channeled side starts from the unfaded pixels, just like a texture.
+	if(!TEST_CHECK(set_palette(pal))) {
+		return;
+	}
+	auto *renderer = SDL_CreateSoftwareRenderer(target);
+	defer(SDL_DestroyRenderer(renderer));
+	auto *tex = SDL_CreateTextureFromSurface(renderer, indexed);
+	defer(SDL_DestroyTexture(tex));
+	if(!TEST_CHECK(renderer && tex)) {
+		return;
+	}
+	SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_NONE);
+
+	unsigned int mismatches = 0;
+	for(const auto b : std::views::iota(0, (BRIGHTNESS_WHITE + 1))) {
+		const auto brightness = static_cast<uint16_t>(b);
+
+		TEST_CHECK(set_palette(pal.Fade(brightness)));
+		const auto pixels_8 = Pixels(indexed);
+
+		const auto mod = static_cast<uint8_t>(
+			(std::min)(brightness, BRIGHTNESS_NORMAL)
+		);
+		const auto white = static_cast<uint8_t>(brightness - mod);
+		SDL_SetTextureColorMod(tex, mod, mod, mod);
+		SDL_RenderTexture(renderer, tex, nullptr, nullptr);
+		if(white) {
+			SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+			SDL_SetRenderDrawColor(renderer, 0xFF, 0xFF, 0xFF, white);
+			SDL_RenderFillRect(renderer, nullptr);
+		}
+		SDL_FlushRenderer(renderer);
+		const auto pixels_32 = Pixels(target);
+
+		if(!TEST_CHECK(!pixels_8.empty() && (pixels_8 == pixels_32))) {
+			const auto [it_8, it_32] = std::ranges::mismatch(
+				pixels_8, pixels_32
+			);
+			if((it_8 != pixels_8.end()) && (mismatches == 0)) {
+				printf(
+					"Brightness %d, color %zu: 0x%06X (8-bit) != 0x%06X\n",
+					b,
+					static_cast<size_t>(it_8 - pixels_8.begin()),
+					*it_8,
+					*it_32
+				);
+			}
+			mismatches++;
+		}
+	}
+	printf(
+		"%u of %d brightness levels differ between 8-bit and 32-bit.\n",
+		mismatches,
+		(BRIGHTNESS_WHITE + 1)
+	);
+} };
@@ -0,0 +1,162 @@
+/*
+ *   Tests for crash-safe file replacement
+ *
+ */
+
+#include <SDL3/SDL_filesystem.h>
+#include <SDL3/SDL_iostream.h>
+
+#include "test/test.h"
+#include "game/hash.h"
+#include "platform/file.h"
+
+static constexpr auto FN = u8"test_file_replace.bin";
+static constexpr auto FN_TEMP = u8"test_file_replace.bin.tmp";
+
+static const std::vector<uint8_t> DATA_OLD(4096, 0x11);
+static const std::vector<uint8_t> DATA_NEW(8192, 0x22);
+
+static bool FileEquals(const char8_t *fn, const std::vector<uint8_t>& data)
+{
+	const auto buf = SDL_LoadFile(fn);
+	return (
+		buf && std::ranges::equal(std::span{ buf.get(), buf.size() }, data)
+	);
+}
+
+static bool FileExists(const char8_t *fn)
+{
+	return SDL_GetPathInfo(std::bit_cast<const char *>(fn), nullptr);
+}
+
+static void Cleanup(void)
+{
+	SDL_RemovePath(std::bit_cast<const char *>(FN));
+	SDL_RemovePath(std::bit_cast<const char *>(FN_TEMP));
+}
+
+// Starts replacing [FN] with the first half of [DATA_NEW].
+static SDL_IOStream *ReplaceHalfway(void)
+{
+	auto *stream = File_ReplaceStart(FN);
+	if(!TEST_CHECK(stream != nullptr)) {
+		return nullptr;
+	}
+	const auto half = std::span{ DATA_NEW }.first(DATA_NEW.size() / 2);
+	TEST_CHECK(SDL_MustWriteIO(stream, half.data(), half.size()));
+	return stream;
+}
+
+static const TEST FileReplaceInterrupted = { "file/replace_interrupted", [] {
+	Cleanup();
+	if(!TEST_CHECK(File_Replace(FN, DATA_OLD)) || !FileEquals(FN, DATA_OLD)) {
+		return;
+	}
+
+	// A crash in the middle of the write leaves the temporary file behind,
+	// but never touches the target.
+	if(auto *stream = ReplaceHalfway()) {
+		SDL_CloseIO(stream);
+		TEST_CHECK(FileEquals(FN, DATA_OLD));
+	}
+
+	// Aborting also removes the temporary file.
+	if(auto *stream = ReplaceHalfway()) {
+		File_ReplaceAbort(std::move(stream), FN);
+		TEST_CHECK(FileEquals(FN, DATA_OLD));
+		TEST_CHECK(!FileExists(FN_TEMP));
+	}
+
+	// The next replacement still goes through.
+	TEST_CHECK(File_Replace(FN, DATA_NEW));
+	TEST_CHECK(FileEquals(FN, DATA_NEW));
+	TEST_CHECK(!FileExists(FN_TEMP));
+	Cleanup();
+} };
+
+// Writes [data] with a hash trailer, then verifies the file read back from
+// disk after applying [corrupt] to it.
+static std::optional<std::vector<uint8_t>> ChecksumRoundtrip(
+	const std::vector<uint8_t>& data,
+	bool required,
+	void (*corrupt)(std::vector<uint8_t>& file)
+)
+{
+	auto file = data;
+	const auto trailer = HashTrailer(data);
+	file.insert(file.end(), trailer.begin(), trailer.end());
+	corrupt(file);
+	if(!TEST_CHECK(File_Replace(FN, file))) {
+		return std::nullopt;
+	}
+	const auto buf = SDL_LoadFile(FN);
+	const auto verified = HashTrailerVerify(
+		{ buf.get(), buf.size() }, required
+	);
+	if(!verified) {
+		return std::nullopt;
+	}
+	return std::vector<uint8_t>{ verified->begin(), verified->end() };
+}
+
+static const TEST FileChecksum = { "file/checksum", [] {
+	Cleanup();
+	const auto intact = [](std::vector<uint8_t>&) {};
+	TEST_CHECK(ChecksumRoundtrip(DATA_NEW, true, intact) == DATA_NEW);
+
+	// Any flipped bit in either the data or the hash rejects the file.
+	TEST_CHECK(!ChecksumRoundtrip(DATA_NEW, false, [](auto& file) {
+		file[DATA_NEW.size() / 2] ^= 0x01;
+	}));
+	TEST_CHECK(!ChecksumRoundtrip(DATA_NEW, false, [](auto& file) {
+		file[DATA_NEW.size()] ^= 0x80;
+	}));
+
+	// A file cut off in the middle of the write has no trailer. Formats that
+	// always had one reject it, while formats that are also written by the
+	// original game fall back onto their own validation.
+	const auto cut = [](std::vector<uint8_t>& file) {
+		file.resize(file.size() / 2);
+	};
+	TEST_CHECK(!ChecksumRoundtrip(DATA_NEW, true, cut));
+	const auto cut_legacy = ChecksumRoundtrip(DATA_NEW, false, cut);
+	TEST_CHECK(cut_legacy && (cut_legacy->size() == (DATA_NEW.size() / 2)));
+
+	// Files without a trailer, as written by the original game.
+	const auto strip = [](std::vector<uint8_t>& file) {
+		file.resize(DATA_OLD.size());
+	};
+	TEST_CHECK(ChecksumRoundtrip(DATA_OLD, false, strip) == DATA_OLD);
+	TEST_CHECK(!ChecksumRoundtrip(DATA_OLD, true, strip));
+	Cleanup();
+} };
+
+static const TEST FileReplaceCommitFailed = { "file/replace_commit", [] {
+	Cleanup();
+	if(!TEST_CHECK(File_Replace(FN, DATA_OLD))) {
+		return;
+	}
+	auto *stream = ReplaceHalfway();
+	if(!stream) {
+		return;
+	}
+
+	// Make the final rename fail.
+#ifdef WIN32
+	// Windows can't replace a file that is still open without
+	// FILE_SHARE_DELETE, which SDL doesn't request.
+	auto *lock = SDL_IOFromFile(FN, "rb");
+	TEST_CHECK(lock != nullptr);
+#else
+	// POSIX systems can't rename a file that no longer exists.
+	SDL_RemovePath(std::bit_cast<const char *>(FN_TEMP));
+#endif
+	TEST_CHECK(!File_ReplaceCommit(std::move(stream), FN));
+#ifdef WIN32
+	SDL_CloseIO(lock);
+#endif
+
+	TEST_CHECK(FileEquals(FN, DATA_OLD));
+	TEST_CHECK(!FileExists(FN_TEMP));
+	Cleanup();
+} };
@@ -0,0 +1,132 @@
+/*
+ *   Tests for the bitmap fonts
+ *
+ */
+
+#include "test/test.h"
+#include "test/graphics.h"
+#include "game/defer.h"
+#include "GIAN07/FONTUTY.H"
+
+// GrpPutScore() before sprite batching, calling [blit] instead of
+// GrpSurface_Blit().
+static void GrpPutScorePerDigit(int x, int y, const char *s, auto&& blit)
+{
+	PIXEL_LTRB src;
+	for(; (*s) != '\0'; s++, x += 6) {
+		if(((*s) >= '0') && ((*s) <= '9')) {
+			src = PIXEL_LTWH{ (((*s - '0') << 3) + 128), 88, 5, 7 };
+		} else {
+			continue;
+		}
+		if((x >= 0) && (x < 630)) {
+			blit(WINDOW_POINT{ x, y }, src);
+		}
+	}
+}
+
+static bool SpriteEquals(const GRP_SPRITE& a, const GRP_SPRITE& b)
+{
+	return (
+		(a.topleft.x == b.topleft.x) && (a.topleft.y == b.topleft.y) &&
+		(a.src.left == b.src.left) && (a.src.top == b.src.top) &&
+		(a.src.right == b.src.right) && (a.src.bottom == b.src.bottom)
+	);
+}
+
+static const TEST ScoreSprites = { "fontuty/score/sprites", [] {
+	constexpr std::string_view CHARS = "0123456789 -a";
+	std::mt19937 rng{ 0x5C0E };
+	for(int i = 0; i < 10000; i++) {
+		std::string s(rng() % 40, '\0');
+		for(auto& c : s) {
+			// Mostly digits, like all strings the game actually draws.
+			c = CHARS[rng() % (((rng() % 8) == 0) ? CHARS.size() : 10)];
+		}
+		const auto x = (static_cast<int>(rng() % 800) - 100);
+		const auto y = (static_cast<int>(rng() % 480));
+
+		std::vector<GRP_SPRITE> expected;
+		GrpPutScorePerDigit(x, y, s.c_str(), [&](auto topleft, auto src) {
+			expected.emplace_back(GRP_SPRITE{ topleft, src });
+		});
+
+		std::vector<GRP_SPRITE> batched;
+		GrpScoreSprites(x, y, s, [&](std::span<const GRP_SPRITE> sprites) {
+			TEST_CHECK(!sprites.empty());
+			batched.insert(batched.end(), sprites.begin(), sprites.end());
+		});
+
+		TEST_CHECK(std::ranges::equal(batched, expected, SpriteEquals));
+	}
+} };
+
+// Draws 1000 score popups per frame, as they would appear when a bomb clears
+// a screen full of bullets, both via sprintf() and individual blits like the
+// original game and via the batched GrpPutScore(). Runs on the software
+// renderer, which is slower than any GPU, but also shows the per-call
+// overhead that the batching removes.
+static const TEST ScoreBenchmark = { "fontuty/score/benchmark", [] {
+	using namespace std::chrono;
+
+	constexpr int POPUPS = 1000;
+	constexpr int FRAMES = 60;
+
+	constexpr PIXEL_SIZE SYSTEM_SIZE = { 256, 128 };
+
+	if(!TEST_CHECK(TestGrp_Init())) {
+		return;
+	}
+	defer(TestGrp_Cleanup());
+	if(!TEST_CHECK(TestGrp_SurfaceRandom(SURFACE_ID::SYSTEM, SYSTEM_SIZE, 1))) {
+		return;
+	}
+
+	struct POPUP {
+		int x;
+		int y;
+		uint32_t point;
+	};
+	std::mt19937 rng{ 0x9090 };
+	std::vector<POPUP> popups;
+	for(int i = 0; i < POPUPS; i++) {
+		popups.emplace_back(POPUP{
+			.x = static_cast<int>(rng() % 640),
+			.y = static_cast<int>(rng() % 480),
+			.point = ((rng() % 512) * 100),
+		});
+	}
+
+	const auto timed = [&](auto&& draw) {
+		const auto start = steady_clock::now();
+		for(int frame = 0; frame < FRAMES; frame++) {
+			for(const auto& popup : popups) {
+				draw(popup);
+			}
+
+			// Locking the backbuffer waits for the renderer.
+			GrpBackend_PixelAccessLock();
+			GrpBackend_PixelAccessUnlock();
+		}
+		return duration_cast<microseconds>(
+			(steady_clock::now() - start) / FRAMES
+		);
+	};
+	const auto t_per_digit = timed([](const POPUP& popup) {
+		char buf[16];
+		snprintf(buf, sizeof(buf), "%u", popup.point);
+		GrpPutScorePerDigit(popup.x, popup.y, buf, [](auto topleft, auto src) {
+			GrpSurface_Blit(topleft, SURFACE_ID::SYSTEM, src);
+		});
+	});
+	const auto t_batched = timed([](const POPUP& popup) {
+		GrpPutScore(popup.x, popup.y, popup.point);
+	});
+
+	printf(
+		"%d popups: %lld us per frame (batched) / %lld us (per digit)\n",
+		POPUPS,
+		static_cast<long long>(t_batched.count()),
+		static_cast<long long>(t_per_digit.count())
+	);
+}, true };
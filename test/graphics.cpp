@@ -0,0 +1,90 @@
+/*
+ *   Headless graphics backend for tests
+ *
+ */
+
+#include <SDL3/SDL_hints.h>
+#include <SDL3/SDL_init.h>
+
+#include "test/graphics.h"
+
+bool TestGrp_Init(void)
+{
+	SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "dummy");
+	if(!SDL_InitSubSystem(SDL_INIT_VIDEO)) {
+		return false;
+	}
+	const GRAPHICS_PARAMS params = {
+		.flags = GRAPHICS_PARAM_FLAGS{},
+		.device_id = 0,
+		.api = -1,
+		.window_scale_4x = 4,
+		.left = GRAPHICS_TOPLEFT_UNDEFINED,
+		.top = GRAPHICS_TOPLEFT_UNDEFINED,
+		.bitdepth = BITDEPTHS::find(32),
+	};
+	if(
+		!GrpBackend_Enum() ||
+		!Grp_InitOrFallback(params) ||
+		!GrpBackend_PixelAccessStart() ||
+		(GrpBackend_PixelFormat().PixelSize() != PIXELFORMAT::SIZE32)
+	) {
+		TestGrp_Cleanup();
+		return false;
+	}
+	GrpBackend_SetClip(GRP_RES_RECT);
+	GrpBackend_Clear();
+	return true;
+}
+
+void TestGrp_Cleanup(void)
+{
+	GrpBackend_PixelAccessEnd();
+	GrpBackend_Cleanup();
+	SDL_QuitSubSystem(SDL_INIT_VIDEO);
+}
+
+bool TestGrp_SurfaceRandom(
+	SURFACE_ID sid,
+	const PIXEL_SIZE& size,
+	uint32_t seed,
+	unsigned int transparent_every
+)
+{
+	if(!GrpSurface_CreateUninitialized(sid, size, GrpBackend_PixelFormat())) {
+		return false;
+	}
+
+	// All of our 32-bit formats store alpha in the last byte.
+	std::mt19937 rng{ seed };
+	std::vector<uint32_t> pixels(size.w * size.h);
+	for(auto& pixel : pixels) {
+		const auto opaque = ((rng() % transparent_every) != 0);
+		pixel = ((rng() & 0xFFFFFF) | (opaque ? 0xFF000000 : 0x00000000));
+	}
+	GrpSurface_Update(sid, nullptr, {
+		std::bit_cast<const std::byte *>(pixels.data()),
+		(static_cast<size_t>(size.w) * sizeof(uint32_t)),
+	});
+	return true;
+}
+
+std::vector<uint32_t> TestGrp_Pixels(void)
+{
+	std::vector<uint32_t> ret;
+	const auto [pixels, pitch] = GrpBackend_PixelAccessLock();
+	if(pitch == 0) {
+		return ret;
+	}
+	ret.reserve(GRP_RES.w * GRP_RES.h);
+	const auto *row = pixels;
+	for(const auto y : std::views::iota(0, GRP_RES.h)) {
+		const auto *p = std::bit_cast<const uint32_t *>(row);
+		for(const auto x : std::views::iota(0, GRP_RES.w)) {
+			ret.emplace_back(p[x] & 0xFFFFFF);
+		}
+		row += pitch;
+	}
+	GrpBackend_PixelAccessUnlock();
+	return ret;
+}
@@ -0,0 +1,31 @@
+/*
+ *   Headless graphics backend for tests
+ *
+ */
+
+#pragma once
+
+#include "platform/graphics_backend.h"
+
+// Brings up the graphics backend on SDL's dummy video driver, in the same
+// software-rendered pixel access mode that replay export uses, and clears the
+// backbuffer. Returns `false` if the backend didn't come up with a 32-bit
+// pixel format.
+bool TestGrp_Init(void);
+
+// Shuts down everything brought up by TestGrp_Init().
+void TestGrp_Cleanup(void);
+
+// (Re-)creates [sid] with the given size and fills it with random colors.
+// One in [transparent_every] pixels is fully transparent, like the color key
+// in the game's own sprite sheets.
+bool TestGrp_SurfaceRandom(
+	SURFACE_ID sid,
+	const PIXEL_SIZE& size,
+	uint32_t seed,
+	unsigned int transparent_every = 4
+);
+
+// Returns a copy of the backbuffer's color channels, one pixel per element and
+// row by row.
+std::vector<uint32_t> TestGrp_Pixels(void);
@@ -0,0 +1,99 @@
+/*
+ *   Benchmark for parallel hashing
+ *
+ */
+
+#include "test/test.h"
+#include "game/hash.h"
+#include "GIAN07/LZ_UTY.H"
+
+// Roughly the shape of MUSIC.DAT: A few dozen compressed files, each
+// repetitive enough to compress well.
+static constexpr size_t FILE_COUNT = 32;
+static constexpr size_t FILE_SIZE = (256 * 1024);
+
+struct PACKFILE_FIXTURE {
+	std::vector<PBG_FILEINFO> info;
+	PACKFILE_READ pack;
+
+	PACKFILE_FIXTURE() {
+		std::mt19937 rng{ 0x4A54 };
+		BYTE_BUFFER_GROWABLE packed;
+		for(size_t i = 0; i < FILE_COUNT; i++) {
+			BYTE_BUFFER_GROWABLE file(FILE_SIZE);
+			for(size_t j = 0; j < FILE_SIZE; j++) {
+				file[j] = (((j % 64) < 48)
+					? static_cast<uint8_t>((j / 64) + i)
+					: static_cast<uint8_t>(rng())
+				);
+			}
+			info.emplace_back(PBG_FILEINFO{
+				.size_uncompressed = static_cast<fil_size_t>(FILE_SIZE),
+				.offset = static_cast<fil_size_t>(packed.size()),
+				.checksum_compressed = 0,
+			});
+			const auto compressed = Compress(file, 1);
+			packed.insert(packed.end(), compressed.begin(), compressed.end());
+		}
+		BYTE_BUFFER_OWNED buf = { packed.size() };
+		std::ranges::copy(packed, buf.get());
+		pack = PACKFILE_READ{ std::move(buf), info };
+	}
+};
+
+// Compares HashParallel() against hashing the same files one after another on
+// a single thread, both for decompressed packfile entries (as in
+// LoadMusicHashes()) and for uncompressed files that only need to be copied.
+static const TEST HashParallelBenchmark = { "hash/parallel/benchmark", [] {
+	using namespace std::chrono;
+
+	const PACKFILE_FIXTURE f;
+	if(!TEST_CHECK(static_cast<bool>(f.pack))) {
+		return;
+	}
+	const auto expand = [&](size_t i) {
+		return f.pack.MemExpand(static_cast<fil_no_t>(i));
+	};
+	const auto copy = [&](size_t i) {
+		BYTE_BUFFER_OWNED ret = { FILE_SIZE };
+		if(ret) {
+			std::fill_n(ret.get(), FILE_SIZE, static_cast<uint8_t>(i));
+		}
+		return ret;
+	};
+
+	const auto run = [](
+		const char *label,
+		const std::function<BYTE_BUFFER_OWNED(size_t i)>& load
+	) {
+		const THREAD_STOP st = false;
+
+		std::vector<std::optional<HASH>> serial;
+		const auto t_serial_start = steady_clock::now();
+		for(size_t i = 0; i < FILE_COUNT; i++) {
+			const auto buf = load(i);
+			serial.emplace_back(Hash({ buf.get(), buf.size() }));
+		}
+		const auto t_serial = (steady_clock::now() - t_serial_start);
+
+		const auto t_parallel_start = steady_clock::now();
+		const auto parallel = HashParallel(FILE_COUNT, load, st);
+		const auto t_parallel = (steady_clock::now() - t_parallel_start);
+
+		TEST_CHECK(parallel == serial);
+		const auto mib = ((FILE_COUNT * FILE_SIZE) / (1024.0 * 1024.0));
+		const auto mib_per_s = [&](steady_clock::duration t) {
+			return (mib / duration_cast<duration<double>>(t).count());
+		};
+		printf(
+			"%s, %zu x %zu KiB: %.0f MiB/s (parallel) / %.0f MiB/s (serial)\n",
+			label,
+			FILE_COUNT,
+			(FILE_SIZE / 1024),
+			mib_per_s(t_parallel),
+			mib_per_s(t_serial)
+		);
+	};
+	run("Decompressed", expand);
+	run("Uncompressed", copy);
+}, true };
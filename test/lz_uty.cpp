@@ -0,0 +1,104 @@
+/*
+ *   Tests for packfile compression
+ *
+ */
+
+#include "test/test.h"
+#include "GIAN07/LZ_UTY.H"
+
+// Decompresses [compressed] through a single-file packfile.
+static BYTE_BUFFER_OWNED Expand(
+	const BYTE_BUFFER_GROWABLE& compressed, size_t size_uncompressed
+)
+{
+	BYTE_BUFFER_OWNED packfile = { compressed.size() };
+	std::ranges::copy(compressed, packfile.get());
+	const PBG_FILEINFO info = {
+		.size_uncompressed = static_cast<fil_size_t>(size_uncompressed),
+		.offset = 0,
+		.checksum_compressed = 0,
+	};
+	const PACKFILE_READ read = { std::move(packfile), std::span{ &info, 1 } };
+	return read.MemExpand(0);
+}
+
+// Sample data for every kind of file we pack, with sizes that both fit into
+// the dictionary window and exceed it.
+static std::vector<BYTE_BUFFER_GROWABLE> Samples(void)
+{
+	std::vector<BYTE_BUFFER_GROWABLE> ret;
+	std::mt19937 rng{ 0x5EED };
+	for(const size_t size : { 1, 2, 3, 4, 18, 19, 8191, 8192, 8193, 65536 }) {
+		// Random, and therefore incompressible
+		auto& random = ret.emplace_back(size);
+		std::ranges::generate(random, [&] { return uint8_t(rng()); });
+
+		// Mostly zero, like sparse image data
+		auto& sparse = ret.emplace_back(size, 0x00);
+		for(auto& b : sparse) {
+			b = (((rng() % 32) == 0) ? uint8_t(rng()) : 0x00);
+		}
+
+		// Periodic
+		auto& periodic = ret.emplace_back(size);
+		for(size_t i = 0; i < size; i++) {
+			periodic[i] = static_cast<uint8_t>((i % 37) * 7);
+		}
+
+		// Self-similar, with runs copied from random earlier positions and
+		// occasional mutations, like text or scripts
+		auto& similar = ret.emplace_back();
+		while(similar.size() < size) {
+			if((similar.size() < 16) || ((rng() % 4) == 0)) {
+				similar.emplace_back(uint8_t(rng()));
+				continue;
+			}
+			const auto start = (rng() % similar.size());
+			const auto len = (std::min)(
+				((rng() % 40) + 1), (size - similar.size())
+			);
+			for(size_t i = 0; i < len; i++) {
+				similar.emplace_back(similar[start + i]);
+			}
+		}
+	}
+	return ret;
+}
+
+static const TEST LZSSRoundTrip = { "lz_uty/roundtrip", [] {
+	for(const auto& sample : Samples()) {
+		for(const auto depth : { 1u, LZSS_SEARCH_DEPTH_DEFAULT }) {
+			const auto compressed = Compress(sample, depth);
+			const auto expanded = Expand(compressed, sample.size());
+			if(!TEST_CHECK(expanded.size() == sample.size())) {
+				continue;
+			}
+			TEST_CHECK(std::ranges::equal(
+				std::span{ expanded.get(), expanded.size() }, sample
+			));
+
+			// Literals take 9 bits each, plus the 14-bit sentinel.
+			TEST_CHECK(compressed.size() <= ((sample.size() * 9 + 14 + 7) / 8));
+		}
+	}
+} };
+
+// The default search depth must stay close to an exhaustive search of the
+// dictionary window, which is what the original compressor did.
+static const TEST LZSSRatio = { "lz_uty/ratio", [] {
+	constexpr auto DEPTH_UNLIMITED = (std::numeric_limits<unsigned int>::max)();
+	size_t size_default = 0;
+	size_t size_unlimited = 0;
+	for(const auto& sample : Samples()) {
+		const auto compressed_unlimited = Compress(sample, DEPTH_UNLIMITED);
+		size_default += Compress(sample).size();
+		size_unlimited += compressed_unlimited.size();
+
+		// An exhaustive search still has to round-trip.
+		const auto expanded = Expand(compressed_unlimited, sample.size());
+		TEST_CHECK(std::ranges::equal(
+			std::span{ expanded.get(), expanded.size() }, sample
+		));
+	}
+	TEST_CHECK((size_default * 100) <= (size_unlimited * 102));
+} };
@@ -0,0 +1,104 @@
+/*
+ *   Test runner
+ *
+ */
+
+// GCC 15 can't #include this after a module import.
+#include <stdio.h> // For `stdout`
+
+#include "test/test.h"
+
+// Function-local to sidestep the static initialization order of the TEST
+// objects in other translation units.
+static std::vector<const TEST *>& Tests(void)
+{
+	static std::vector<const TEST *> ret;
+	return ret;
+}
+
+TEST::TEST(const char *name, void (*func)(void), bool benchmark) :
+	name(name), func(func), benchmark(benchmark)
+{
+	Tests().emplace_back(this);
+}
+
+// Failures of the currently running test.
+static unsigned int Failures = 0;
+
+bool Test_Check(bool cond, const char *expr, std::source_location loc)
+{
+	if(!cond) {
+		// Only report the first few failures of checks inside loops.
+		constexpr unsigned int REPORT_MAX = 10;
+		if(Failures < REPORT_MAX) {
+			printf("%s:%u: Failed: %s\n", loc.file_name(), loc.line(), expr);
+		}
+		Failures++;
+	}
+	return cond;
+}
+
+uint64_t Test_ParallelCountFailures(
+	int64_t first, int64_t last, bool (*func)(int64_t v)
+)
+{
+	const int64_t thread_count = (std::max)(
+		std::thread::hardware_concurrency(), 1u
+	);
+	const auto chunk = (((last - first) + thread_count) / thread_count);
+	std::vector<uint64_t> failures(thread_count, 0);
+	std::vector<std::thread> threads;
+	for(int64_t t = 0; t < thread_count; t++) {
+		threads.emplace_back([&, t] {
+			const auto start = (first + (t * chunk));
+			const auto end = (std::min)((start + chunk), (last + 1));
+			for(auto v = start; v < end; v++) {
+				failures[t] += !func(v);
+			}
+		});
+	}
+	for(auto& thread : threads) {
+		thread.join();
+	}
+	return std::accumulate(failures.begin(), failures.end(), uint64_t{ 0 });
+}
+
+// Runs all tests, or only the ones whose names start with any of the given
+// arguments, in name order. Returns 1 if any of them failed.
+int main(int argc, char** args)
+{
+	auto& tests = Tests();
+	std::ranges::sort(tests, {}, [](const TEST *test) {
+		return std::string_view{ test->name };
+	});
+	const auto filters = std::span(args, argc).subspan(1);
+
+	size_t run = 0;
+	size_t failed = 0;
+	for(const auto* test : tests) {
+		const auto requested = std::ranges::any_of(filters, [&](auto filter) {
+			return std::string_view{ test->name }.starts_with(filter);
+		});
+		if(filters.empty() ? test->benchmark : !requested) {
+			continue;
+		}
+		Failures = 0;
+		const auto t_start = std::chrono::steady_clock::now();
+		test->func();
+		const auto t_end = std::chrono::steady_clock::now();
+		const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+			t_end - t_start
+		);
+		printf(
+			"%s %s (%lld ms)\n",
+			((Failures == 0) ? "ok  " : "FAIL"),
+			test->name,
+			static_cast<long long>(ms.count())
+		);
+		fflush(stdout);
+		run++;
+		failed += (Failures != 0);
+	}
+	printf("%zu of %zu tests failed.\n", failed, run);
+	return ((failed == 0) ? 0 : 1);
+}
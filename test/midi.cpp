@@ -0,0 +1,346 @@
+/*
+ *   Tests for MIDI sequence seeking
+ *
+ */
+
+#include "test/test.h"
+#include "game/midi.h"
+
+using namespace std::chrono_literals;
+
+// Synthetic sequence
+// ------------------
+// Three channels with notes, controller changes, program changes, and pitch
+// bends on every beat, plus a tempo map on a separate conductor track. Long
+// enough to span multiple channel state snapshots.
+
+static constexpr uint16_t PPQN = 96;
+static constexpr MID_PULSE BEAT = PPQN;
+static constexpr int BEATS = 200;
+static constexpr MID_PULSE NOTE_LENGTH = 24;
+
+// Tempo changes every 16 beats. All quarter note durations are divisible by
+// PPQN, so that the realtime of every pulse is exact.
+static constexpr MID_PULSE TEMPO_INTERVAL = (16 * BEAT);
+static constexpr uint32_t TEMPOS[] = { 480'000, 600'000, 384'000 };
+
+static void PutBE(std::vector<uint8_t>& buf, uint32_t v, int bytes)
+{
+	for(auto i = (bytes - 1); i >= 0; i--) {
+		buf.emplace_back(static_cast<uint8_t>(v >> (i * 8)));
+	}
+}
+
+static void PutVLQ(std::vector<uint8_t>& buf, uint32_t v)
+{
+	std::array<uint8_t, 5> bytes;
+	size_t n = 0;
+	do {
+		bytes[n++] = (v & 0x7F);
+		v >>= 7;
+	} while(v);
+	while(n > 1) {
+		buf.emplace_back(bytes[--n] | 0x80);
+	}
+	buf.emplace_back(bytes[0]);
+}
+
+struct SMF_TRACK_WRITER {
+	std::vector<uint8_t> data;
+	MID_PULSE pulse = 0;
+
+	void Event(MID_PULSE at, std::initializer_list<uint8_t> bytes) {
+		PutVLQ(data, static_cast<uint32_t>(at - pulse));
+		data.insert(data.end(), bytes);
+		pulse = at;
+	}
+};
+
+static std::vector<uint8_t> SequenceBuild(void)
+{
+	std::vector<SMF_TRACK_WRITER> tracks(4);
+	constexpr MID_PULSE END = (BEATS * BEAT);
+
+	auto& conductor = tracks[0];
+	for(MID_PULSE p = 0; p < END; p += TEMPO_INTERVAL) {
+		const auto tempo = TEMPOS[(p / TEMPO_INTERVAL) % std::size(TEMPOS)];
+		conductor.Event(p, {
+			0xFF, 0x51, 0x03,
+			uint8_t(tempo >> 16), uint8_t(tempo >> 8), uint8_t(tempo >> 0),
+		});
+	}
+	conductor.Event(END, { 0xFF, 0x2F, 0x00 });
+
+	for(uint8_t ch = 0; ch < 3; ch++) {
+		auto& t = tracks[1 + ch];
+		for(int b = 0; b < BEATS; b++) {
+			const auto p = (b * BEAT);
+			const uint8_t cc = (0xB0 + ch);
+			t.Event(p, { cc, 0x07, uint8_t(((b * 7) + (ch * 13)) % 128) });
+			if((b % 3) == ch) {
+				t.Event(p, { cc, 0x0A, uint8_t(((b * 11) + ch) % 128) });
+			}
+			if((b % 5) == 0) {
+				// Running status
+				t.Event(p, { 0x0B, uint8_t(((b * 3) + ch) % 128) });
+			}
+			if((b % 32) == 0) {
+				t.Event(p, { uint8_t(0xC0 + ch), uint8_t(b % 128) });
+			}
+			if((b % 7) == 0) {
+				t.Event(p, { uint8_t(0xE0 + ch), 0x00, uint8_t(b % 128) });
+			}
+			const uint8_t note = (36 + (b % 48));
+			const uint8_t vel = (1 + (((b * 5) + ch) % 127));
+			t.Event(p, { uint8_t(0x90 + ch), note, vel });
+
+			// Alternate between both kinds of Note Off messages.
+			if((b % 2) == 0) {
+				t.Event((p + NOTE_LENGTH), { uint8_t(0x80 + ch), note, 0x40 });
+			} else {
+				t.Event((p + NOTE_LENGTH), { uint8_t(0x90 + ch), note, 0x00 });
+			}
+		}
+		t.Event(END, { 0xFF, 0x2F, 0x00 });
+	}
+
+	std::vector<uint8_t> ret;
+	PutBE(ret, 0x4D546864, 4); // "MThd"
+	PutBE(ret, 6, 4);
+	PutBE(ret, 1, 2);
+	PutBE(ret, static_cast<uint32_t>(tracks.size()), 2);
+	PutBE(ret, PPQN, 2);
+	for(const auto& t : tracks) {
+		PutBE(ret, 0x4D54726B, 4); // "MTrk"
+		PutBE(ret, static_cast<uint32_t>(t.data.size()), 4);
+		ret.insert(ret.end(), t.data.begin(), t.data.end());
+	}
+	return ret;
+}
+
+static void SequenceLoad(const MID_LOOP& loop = {})
+{
+	static const auto smf = SequenceBuild();
+	BYTE_BUFFER_OWNED buf = { smf.size() };
+	std::ranges::copy(smf, buf.get());
+	TEST_CHECK(Mid_Load(std::move(buf)));
+	Mid_SetLoop(loop);
+}
+
+// Realtime of the given pulse, calculated from the tempo map.
+static MID_REALTIME RealtimeAt(MID_PULSE pulse)
+{
+	MID_REALTIME ret = 0s;
+	for(MID_PULSE p = 0; p < pulse; p += TEMPO_INTERVAL) {
+		const auto tempo = TEMPOS[(p / TEMPO_INTERVAL) % std::size(TEMPOS)];
+		const MID_REALTIME qn = std::chrono::microseconds{ tempo };
+		ret += ((qn * (std::min)(TEMPO_INTERVAL, (pulse - p))) / PPQN);
+	}
+	return ret;
+}
+// ------------------
+
+// Everything that Mid_Proc() derives from the event stream and that a seek
+// must restore.
+struct MIDI_OBSERVED_STATE {
+	std::array<uint8_t, 16> volume;
+	std::array<uint8_t, 16> pan;
+	std::array<uint8_t, 16> expression;
+	std::array<std::array<uint8_t, 128>, 16> notes;
+	MID_PULSE pulse_of_last_event_processed;
+
+	static MIDI_OBSERVED_STATE Capture(void) {
+		MIDI_OBSERVED_STATE ret;
+		std::ranges::copy(Mid_VolumeTable, ret.volume.begin());
+		std::ranges::copy(Mid_PanpodTable, ret.pan.begin());
+		std::ranges::copy(Mid_ExpressionTable, ret.expression.begin());
+		for(size_t ch = 0; ch < ret.notes.size(); ch++) {
+			std::ranges::copy(Mid_NoteTable[ch], ret.notes[ch].begin());
+		}
+		ret.pulse_of_last_event_processed = (
+			Mid_PlayTime.pulse_of_last_event_processed
+		);
+		return ret;
+	}
+
+	bool operator==(const MIDI_OBSERVED_STATE&) const = default;
+};
+
+// Plays the sequence from the start up to [pulse] in a single Mid_Proc()
+// call, just like a slow system would.
+static MIDI_OBSERVED_STATE PlayLinear(MID_PULSE pulse)
+{
+	SequenceLoad();
+	Mid_TableInit();
+	Mid_Proc(RealtimeAt(pulse));
+	return MIDI_OBSERVED_STATE::Capture();
+}
+
+// Seeks to [from], then plays up to [pulse] in steps of [step].
+static MIDI_OBSERVED_STATE PlaySeeked(
+	MID_PULSE from, MID_PULSE pulse, MID_REALTIME step
+)
+{
+	SequenceLoad();
+	Mid_Seek(from);
+	auto remaining = (RealtimeAt(pulse) - RealtimeAt(from));
+	while(remaining > 0s) {
+		const auto delta = (std::min)(step, remaining);
+		Mid_Proc(delta);
+		remaining -= delta;
+	}
+	return MIDI_OBSERVED_STATE::Capture();
+}
+
+// Events played after a seek
+// --------------------------
+
+struct MIDI_PLAYED_EVENT {
+	MID_PULSE pulse;
+	uint8_t status;
+	std::vector<uint8_t> data;
+
+	bool operator==(const MIDI_PLAYED_EVENT&) const = default;
+};
+
+static std::vector<MIDI_PLAYED_EVENT> Played;
+
+static void PlayedRecord(
+	MID_PULSE pulse, uint8_t status, std::span<const uint8_t> data
+)
+{
+	Played.emplace_back(MIDI_PLAYED_EVENT{
+		.pulse = pulse,
+		.status = status,
+		.data = { data.begin(), data.end() },
+	});
+}
+
+// Plays [duration] in steps of [step], and returns all events played since
+// the last call.
+static std::vector<MIDI_PLAYED_EVENT> PlayRecorded(
+	MID_REALTIME duration, MID_REALTIME step
+)
+{
+	Mid_ProcObserver = PlayedRecord;
+	while(duration > 0s) {
+		const auto delta = (std::min)(step, duration);
+		Mid_Proc(delta);
+		duration -= delta;
+	}
+	Mid_ProcObserver = nullptr;
+	return std::exchange(Played, {});
+}
+
+// Returns the events that linear playback from the start plays at and after
+// [from] up to [to], in steps of [step] after [from]. The events at [from]
+// are played within the initial call that covers the entire time before.
+static std::vector<MIDI_PLAYED_EVENT> EventsLinear(
+	MID_PULSE from, MID_PULSE to, MID_REALTIME step
+)
+{
+	SequenceLoad();
+	Mid_TableInit();
+	Mid_ProcObserver = PlayedRecord;
+	Mid_Proc(RealtimeAt(from));
+	auto ret = PlayRecorded((RealtimeAt(to) - RealtimeAt(from)), step);
+	std::erase_if(ret, [&](const auto& ev) { return (ev.pulse < from); });
+	return ret;
+}
+
+// Returns the events played from the current position of a seek up to [to],
+// with the same call pattern as EventsLinear(). A seek leaves all events at
+// the target pending, so a Mid_Proc(0s) call plays them.
+static std::vector<MIDI_PLAYED_EVENT> EventsSeeked(
+	MID_PULSE to, MID_REALTIME step
+)
+{
+	const auto from = Mid_PlayTime.pulse_of_last_event_processed;
+	Mid_ProcObserver = PlayedRecord;
+	Mid_Proc(0s);
+	return PlayRecorded((RealtimeAt(to) - RealtimeAt(from)), step);
+}
+// --------------------------
+
+// Compares linear playback against seeking to a target and playing the rest.
+// The comparison points lie in between events, and far enough after the
+// target for any notes that were held across it to have ended.
+static const TEST MidiSeek = { "midi/seek", [] {
+	constexpr MID_PULSE TARGETS[] = {
+		0,
+		1,
+		BEAT,
+		(BEAT + (NOTE_LENGTH / 2)),
+		(TEMPO_INTERVAL - 1),
+		TEMPO_INTERVAL,
+		((TEMPO_INTERVAL * 5) + NOTE_LENGTH),
+		((BEATS - 3) * BEAT),
+	};
+	for(const auto from : TARGETS) {
+		for(const auto beats : { 1, 2, 17 }) {
+			const auto to = (from + NOTE_LENGTH + (beats * BEAT) + 1);
+			if(to >= (BEATS * BEAT)) {
+				continue;
+			}
+			const auto expected = PlayLinear(to);
+			TEST_CHECK(PlaySeeked(from, to, 1s) == expected);
+			TEST_CHECK(PlaySeeked(from, to, 1ms) == expected);
+
+			for(const auto step : { MID_REALTIME{ 1s }, MID_REALTIME{ 1ms } }) {
+				const auto expected_events = EventsLinear(from, to, step);
+				SequenceLoad();
+				Mid_Seek(from);
+				const auto events = EventsSeeked(to, step);
+				TEST_CHECK(!events.empty() && (events == expected_events));
+			}
+		}
+	}
+} };
+
+// Mid_SeekBy() must land on the pulse at the given realtime distance, across
+// tempo changes, and play the same events from there as linear playback.
+static const TEST MidiSeekBy = { "midi/seek_by", [] {
+	constexpr MID_PULSE FROM = ((TEMPO_INTERVAL * 2) - BEAT);
+	constexpr MID_PULSE TARGETS[] = {
+		FROM, (FROM + 1), (FROM + (3 * BEAT)), 0
+	};
+	for(const auto to : TARGETS) {
+		SequenceLoad();
+		Mid_Seek(FROM);
+		Mid_SeekBy(RealtimeAt(to) - RealtimeAt(FROM));
+		TEST_CHECK(Mid_PlayTime.pulse_of_last_event_processed == to);
+
+		const auto until = (to + (3 * BEAT));
+		const auto events = EventsSeeked(until, 1ms);
+		TEST_CHECK(!events.empty() && (events == EventsLinear(to, until, 1ms)));
+	}
+} };
+
+// Seeking past the loop end point must wrap around to the same state that
+// playback reaches on its second pass through the loop.
+static const TEST MidiSeekLoop = { "midi/seek_loop", [] {
+	// Both loop points lie within segments of the same tempo, which playback
+	// keeps when wrapping around.
+	constexpr MID_LOOP LOOP = {
+		.start = ((TEMPO_INTERVAL * 1) + (2 * BEAT)),
+		.end = ((TEMPO_INTERVAL * 4) + (5 * BEAT)),
+	};
+	static_assert(
+		TEMPOS[(LOOP.start / TEMPO_INTERVAL) % std::size(TEMPOS)] ==
+		TEMPOS[(LOOP.end / TEMPO_INTERVAL) % std::size(TEMPOS)]
+	);
+	constexpr auto TO = (LOOP.start + (3 * BEAT) + NOTE_LENGTH + 1);
+
+	// Mid_Proc() only reports the highest pulse processed within a single
+	// call, so the second pass needs its own call.
+	SequenceLoad(LOOP);
+	Mid_Seek(0);
+	Mid_Proc(RealtimeAt(LOOP.end));
+	Mid_Proc(RealtimeAt(TO) - RealtimeAt(LOOP.start));
+	const auto expected = MIDI_OBSERVED_STATE::Capture();
+
+	SequenceLoad(LOOP);
+	Mid_Seek(LOOP.end + BEAT);
+	Mid_Proc(RealtimeAt(TO) - RealtimeAt(LOOP.start + BEAT));
+	TEST_CHECK(MIDI_OBSERVED_STATE::Capture() == expected);
+} };
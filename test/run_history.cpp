@@ -0,0 +1,119 @@
+/*
+ *   Tests for the run history
+ *
+ */
+
+#include "test/test.h"
+#include "GIAN07/run_history.h"
+#include "GIAN07/LEVEL.H"
+#include "GIAN07/LOADER.H"
+
+// Generates a valid record with random statistics.
+static RUN_RECORD RandomRecord(std::mt19937& rng, int64_t time_start)
+{
+	RUN_RECORD ret = {};
+	ret.time_start = time_start;
+	ret.time_end = (time_start + 1 + (rng() % 3600));
+	ret.level = (rng() % (GAME_EXTRA + 1));
+	ret.weapon = (rng() % 3);
+	ret.end = static_cast<RUN_END>(rng() % std::size(RUN_END_NAMES));
+	ret.flags = (rng() % 4);
+	ret.stage_count = ((ret.level == GAME_EXTRA) ? 1 : (1 + (rng() % 6)));
+
+	int64_t score = 0;
+	for(uint8_t i = 0; i < ret.stage_count; i++) {
+		auto& stage = ret.stages[i];
+		score += (rng() % 10'000'000);
+		stage.score = score;
+		stage.graze = (rng() % 3000);
+		stage.stage = ((ret.level == GAME_EXTRA) ? GRAPH_ID_EXSTAGE : (i + 1));
+		stage.bombs = (rng() % 10);
+		stage.misses = (rng() % 5);
+		stage.continues = (rng() % 2);
+	}
+	std::ranges::generate(ret.replay, [&] { return std::byte(rng()); });
+	ret.sum = ret.Sum();
+	return ret;
+}
+
+static void Append(std::vector<uint8_t>& file, const RUN_RECORD& record)
+{
+	const auto* p = reinterpret_cast<const uint8_t *>(&record);
+	file.insert(file.end(), p, (p + sizeof(record)));
+}
+
+static const TEST RunHistoryParse = { "run_history/parse", [] {
+	constexpr int RUNS = 100'000;
+
+	std::mt19937 rng{ 0x5EED };
+	std::vector<uint8_t> file;
+	std::vector<RUN_RECORD> expected;
+	for(int i = 0; i < RUNS; i++) {
+		const auto record = RandomRecord(rng, (1'700'000'000 + (i * 600)));
+		Append(file, record);
+		expected.emplace_back(record);
+
+		if((i % 10'000) == 500) {
+			// Torn record from a crash, followed by further appends
+			const auto* p = reinterpret_cast<const uint8_t *>(&record);
+			file.insert(file.end(), p, (p + 77));
+		} else if((i % 10'000) == 900) {
+			// Corrupted byte within the record
+			file[file.size() - 100] ^= 0xFF;
+			expected.pop_back();
+		} else if((i % 10'000) == 1300) {
+			// Valid checksum, but invalid contents
+			auto invalid = record;
+			invalid.stage_count = 0;
+			invalid.sum = invalid.Sum();
+			Append(file, invalid);
+		} else if((i % 10'000) == 1700) {
+			// Garbage that contains a header
+			file.insert(file.end(), RUN_HEADNAME.begin(), RUN_HEADNAME.end());
+			file.insert(file.end(), 200, 0xCC);
+		}
+	}
+
+	// Torn header at the end of the file
+	file.insert(file.end(), RUN_HEADNAME.begin(), (RUN_HEADNAME.end() - 1));
+
+	const auto records = RunHistory_Parse({ file.data(), file.size() });
+	if(TEST_CHECK(records.size() == expected.size())) {
+		TEST_CHECK(memcmp(
+			records.data(),
+			expected.data(),
+			(expected.size() * sizeof(RUN_RECORD))
+		) == 0);
+	}
+
+	// Every run is counted exactly once, in sorted groups.
+	const auto stats = RunHistory_Stats(records);
+	const auto runs = std::accumulate(
+		stats.begin(), stats.end(), size_t{ 0 }, [](size_t sum, const auto& s) {
+			return (sum + s.runs);
+		}
+	);
+	TEST_CHECK(runs == records.size());
+	TEST_CHECK(std::ranges::is_sorted(stats, {}, [](const RUN_STATS& s) {
+		return std::tuple{ s.practice, s.stage, s.level, s.weapon };
+	}));
+
+	// One row per stage, plus the header.
+	const auto stages = std::accumulate(
+		records.begin(), records.end(), size_t{ 0 }, [](size_t sum, auto& r) {
+			return (sum + r.stage_count);
+		}
+	);
+	const auto csv = RunHistory_CSV(records);
+	TEST_CHECK(size_t(std::ranges::count(csv, '\n')) == (stages + 1));
+} };
+
+static const TEST RunHistoryParseEmpty = { "run_history/parse_empty", [] {
+	TEST_CHECK(RunHistory_Parse({}).empty());
+
+	std::mt19937 rng{ 0 };
+	std::vector<uint8_t> file;
+	Append(file, RandomRecord(rng, 0));
+	file.pop_back();
+	TEST_CHECK(RunHistory_Parse({ file.data(), file.size() }).empty());
+} };
@@ -0,0 +1,178 @@
+/*
+ *   Tests for the screenshot encoding pipeline
+ *
+ */
+
+#include <SDL3/SDL_filesystem.h>
+#include <SDL3/SDL_surface.h>
+
+#include "test/test.h"
+#include "game/defer.h"
+#include "game/graphics.h"
+
+static constexpr auto DIR = u8"test_screenshots/";
+static constexpr auto DIR_C = "test_screenshots/";
+
+using SCREENSHOT_FILES = std::vector<std::pair<std::string, uint64_t>>;
+
+// Returns the names and sizes of all files in [DIR], sorted by name.
+static SCREENSHOT_FILES ScreenshotFiles(void)
+{
+	SCREENSHOT_FILES ret;
+	SDL_EnumerateDirectory(DIR_C, [](
+		void *ret_p, const char *, const char *fn
+	) {
+		auto& ret = *static_cast<SCREENSHOT_FILES *>(ret_p);
+		const auto path = (std::string{ DIR_C } + fn);
+		SDL_PathInfo info;
+		if(SDL_GetPathInfo(path.c_str(), &info)) {
+			ret.emplace_back(fn, info.size);
+		}
+		return SDL_ENUM_CONTINUE;
+	}, &ret);
+	std::ranges::sort(ret);
+	return ret;
+}
+
+static void ScreenshotFilesRemove(void)
+{
+	for(const auto& [fn, size] : ScreenshotFiles()) {
+		SDL_RemovePath((std::string{ DIR_C } + fn).c_str());
+	}
+}
+
+// Removes the test directory, and restores the default screenshot settings.
+static void ScreenshotCleanup(void)
+{
+	ScreenshotFilesRemove();
+	SDL_RemovePath(DIR_C);
+	Grp_ScreenshotSetWorkers(std::nullopt);
+	Grp_ScreenshotSetPrefix(u8"");
+}
+
+// Like a game frame: a vertical gradient with a bunch of solid sprites.
+static SDL_Surface *SyntheticFrame(PIXEL_SIZE size, uint32_t seed)
+{
+	auto *ret = SDL_CreateSurface(size.w, size.h, SDL_PIXELFORMAT_XRGB8888);
+	if(!ret) {
+		return nullptr;
+	}
+	auto *row = static_cast<std::byte *>(ret->pixels);
+	for(const auto y : std::views::iota(0, size.h)) {
+		const auto v = static_cast<uint8_t>((y * 255) / size.h);
+		const auto c = SDL_MapSurfaceRGB(ret, 0, (v / 2), v);
+		std::fill_n(std::bit_cast<uint32_t *>(row), size.w, c);
+		row += ret->pitch;
+	}
+	std::mt19937 rng{ seed };
+	for(int i = 0; i < 200; i++) {
+		const SDL_Rect rect = {
+			.x = static_cast<int>(rng() % size.w),
+			.y = static_cast<int>(rng() % size.h),
+			.w = static_cast<int>(4 + (rng() % 32)),
+			.h = static_cast<int>(4 + (rng() % 32)),
+		};
+		const auto c = static_cast<uint8_t>(rng());
+		SDL_FillSurfaceRect(ret, &rect, SDL_MapSurfaceRGB(ret, c, ~c, 0xFF));
+	}
+	return ret;
+}
+
+// A burst of screenshots must be numbered in the order they were taken, even
+// if later ones finish encoding first. The first one is by far the largest.
+static const TEST ScreenshotOrder = { "screenshot/order", [] {
+	constexpr int COUNT = 8;
+
+	Grp_ScreenshotSetPrefix(DIR);
+	defer(ScreenshotCleanup());
+	ScreenshotFilesRemove();
+	TEST_CHECK(Grp_ScreenshotSetWorkers(std::nullopt));
+
+	const auto size_for = [](int i) {
+		const PIXEL_COORD side = ((i == 0) ? 2048 : (16 + i));
+		return PIXEL_SIZE{ side, side };
+	};
+	for(const auto i : std::views::iota(0, COUNT)) {
+		auto *frame = SyntheticFrame(size_for(i), i);
+		if(!TEST_CHECK(frame != nullptr)) {
+			return;
+		}
+		const auto t_start = std::chrono::steady_clock::now();
+		TEST_CHECK(Grp_ScreenshotSave(frame, t_start, 0));
+		SDL_DestroySurface(frame);
+	}
+	TEST_CHECK(Grp_ScreenshotFlush());
+
+	const auto files = ScreenshotFiles();
+	if(!TEST_CHECK(files.size() == COUNT)) {
+		return;
+	}
+	for(const auto i : std::views::iota(0, COUNT)) {
+		const auto path = (std::string{ DIR_C } + files[i].first);
+		auto *bmp = SDL_LoadBMP(path.c_str());
+		if(!TEST_CHECK(bmp != nullptr)) {
+			continue;
+		}
+		TEST_CHECK((bmp->w == size_for(i).w) && (bmp->h == size_for(i).h));
+		SDL_DestroySurface(bmp);
+	}
+} };
+
+// Encodes a batch of 640×480 frames at every effort level, once directly on
+// the calling thread like the original single-threaded code, and once on the
+// worker pool. Lossless encoding must produce the same files either way.
+static const TEST ScreenshotBenchmark = { "screenshot/benchmark", [] {
+	using namespace std::chrono;
+
+	constexpr int COUNT = 8;
+	constexpr PIXEL_SIZE SIZE = { 640, 480 };
+
+	Grp_ScreenshotSetPrefix(DIR);
+	defer(ScreenshotCleanup());
+	ScreenshotFilesRemove();
+
+	std::vector<SDL_Surface *> frames;
+	defer(std::ranges::for_each(frames, SDL_DestroySurface));
+	for(const auto i : std::views::iota(0, COUNT)) {
+		frames.emplace_back(SyntheticFrame(SIZE, i));
+		if(!TEST_CHECK(frames.back() != nullptr)) {
+			return;
+		}
+	}
+
+	// Returns the time taken and the sizes of the resulting files.
+	const auto run = [&](std::optional<unsigned int> workers, uint8_t effort) {
+		TEST_CHECK(Grp_ScreenshotSetWorkers(workers));
+		const auto t_start = steady_clock::now();
+		for(auto *frame : frames) {
+			TEST_CHECK(Grp_ScreenshotSave(frame, t_start, effort));
+		}
+		TEST_CHECK(Grp_ScreenshotFlush());
+		const auto t_end = steady_clock::now();
+		const auto time = duration_cast<milliseconds>(t_end - t_start);
+
+		std::vector<uint64_t> sizes;
+		for(const auto& [fn, size] : ScreenshotFiles()) {
+			sizes.emplace_back(size);
+		}
+		ScreenshotFilesRemove();
+		return std::pair{ time, sizes };
+	};
+
+	for(const auto i : std::views::iota(0u, GRP_SCREENSHOT_EFFORT_COUNT)) {
+		const auto effort = static_cast<uint8_t>(i);
+		const auto [time_single, sizes_single] = run(0, effort);
+		const auto [time_pool, sizes_pool] = run(std::nullopt, effort);
+		TEST_CHECK(sizes_single.size() == COUNT);
+		TEST_CHECK(sizes_pool == sizes_single);
+		printf(
+			"Effort %2u: %6llu B/frame, %lld ms (single) / %lld ms (pool)\n",
+			i,
+			static_cast<unsigned long long>(std::accumulate(
+				sizes_pool.begin(), sizes_pool.end(), uint64_t{ 0 }
+			) / COUNT),
+			static_cast<long long>(time_single.count()),
+			static_cast<long long>(time_pool.count())
+		);
+	}
+}, true };
@@ -0,0 +1,79 @@
+/*
+ *   Tests for the spectrum analyzer
+ *
+ */
+
+#include "test/test.h"
+#include "game/spectrum.h"
+
+static constexpr uint32_t SAMPLINGRATE = 44100;
+static constexpr size_t BANDS = 32;
+static constexpr float BIN_WIDTH = (
+	static_cast<float>(SAMPLINGRATE) / SPECTRUM_FFT_SIZE
+);
+
+// Analyzes a sine wave with the given frequency and amplitude.
+static std::array<float, BANDS> AnalyzeSine(float freq, float amplitude)
+{
+	constexpr auto TAU = (2.0 * std::numbers::pi);
+	std::array<float, SPECTRUM_FFT_SIZE> samples;
+	for(size_t i = 0; i < samples.size(); i++) {
+		const auto phase = ((TAU * freq * i) / SAMPLINGRATE);
+		samples[i] = static_cast<float>(amplitude * std::sin(phase));
+	}
+	std::array<float, BANDS> ret;
+	Spectrum_Analyze(samples, SAMPLINGRATE, ret);
+	return ret;
+}
+
+// Sweeps a full-scale sine wave across the center of every FFT bin between
+// 50 Hz and 16 kHz. Bin-centered tones have no scalloping loss, so the bands
+// covering the tone's bin must read 0 dB, and all bands that start at least
+// two bins away must stay near silence.
+static const TEST SpectrumSweep = { "spectrum/sweep", [] {
+	// Bin ranges of each band, calculated in the same way as
+	// Spectrum_Analyze().
+	std::array<std::pair<size_t, size_t>, BANDS> band_bins;
+	const auto ratio = std::pow((16000.0f / 50.0f), (1.0f / BANDS));
+	auto freq = 50.0f;
+	for(auto& bins : band_bins) {
+		bins.first = static_cast<size_t>(freq / BIN_WIDTH);
+		freq *= ratio;
+		bins.second = (std::max)(
+			bins.first, static_cast<size_t>(freq / BIN_WIDTH)
+		);
+	}
+
+	const auto k_first = static_cast<size_t>(std::ceil(50.0f / BIN_WIDTH));
+	const auto k_last = static_cast<size_t>(16000.0f / BIN_WIDTH);
+	for(auto k = k_first; k <= k_last; k++) {
+		const auto bands = AnalyzeSine((k * BIN_WIDTH), 1.0f);
+		for(size_t b = 0; b < BANDS; b++) {
+			const auto [first, last] = band_bins[b];
+			if((k >= first) && (k <= last)) {
+				TEST_CHECK(std::abs(bands[b]) < 0.1f);
+			} else if((k + 2 <= first) || (k >= last + 2)) {
+				TEST_CHECK(bands[b] < -40.0f);
+			}
+		}
+	}
+} };
+
+static const TEST SpectrumLevels = { "spectrum/levels", [] {
+	// Halving the amplitude lowers the level by 6 dB.
+	const auto freq = (100 * BIN_WIDTH);
+	const auto full = AnalyzeSine(freq, 1.0f);
+	const auto half = AnalyzeSine(freq, 0.5f);
+	const auto loudest = std::ranges::max_element(full);
+	const auto b = (loudest - full.begin());
+	TEST_CHECK(std::abs(*loudest) < 0.1f);
+	TEST_CHECK(std::abs(half[b] - (*loudest - 6.02f)) < 0.1f);
+
+	// Silence is clamped to the -120 dB floor of the logarithm.
+	std::array<float, SPECTRUM_FFT_SIZE> silence = {};
+	std::array<float, BANDS> bands;
+	Spectrum_Analyze(silence, SAMPLINGRATE, bands);
+	for(const auto band : bands) {
+		TEST_CHECK(band <= -120.0f);
+	}
+} };
@@ -0,0 +1,42 @@
+/*
+ *   Test runner
+ *
+ */
+
+#pragma once
+
+import std.compat;
+
+// Tests register themselves during static initialization, just like
+// SNAPSHOT_STATE or ENTITY_POOL objects, and are run by the GIAN07_test
+// binary. Each test is linked against the entire game except for its entry
+// point, and runs within the same process as all other tests.
+
+struct TEST {
+	const char *const name;
+	void (*const func)(void);
+
+	// Benchmarks only report timings, and therefore only run if requested on
+	// the command line.
+	const bool benchmark;
+
+	TEST(const char *name, void (*func)(void), bool benchmark = false);
+};
+
+// Records a failure of the currently running test if [cond] is `false`, and
+// returns [cond].
+bool Test_Check(
+	bool cond,
+	const char *expr,
+	std::source_location loc = std::source_location::current()
+);
+
+#define TEST_CHECK(cond) Test_Check((cond), #cond)
+
+// Calls [func] for every value in [first, last], split across all hardware
+// threads, and returns the number of values for which it returned `false`.
+// Since Test_Check() is not thread-safe, [func] should only return its result,
+// and leave the checking to the calling thread.
+uint64_t Test_ParallelCountFailures(
+	int64_t first, int64_t last, bool (*func)(int64_t v)
+);
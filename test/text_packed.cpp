@@ -0,0 +1,226 @@
+/*
+ *   Tests for the rectangle packer of text surfaces
+ *
+ */
+
+#include "test/test.h"
+#include "test/graphics.h"
+#include "game/defer.h"
+#include "game/text_packed.h"
+
+// Exposes the packer state for inspection.
+struct TEXTRENDER_PACKED_INSPECT : public TEXTRENDER_PACKED {
+	// Checks that the live rectangles and empty spaces partition the canvas
+	// exactly, and that the live rectangles keep the given sizes.
+	bool Valid(const std::map<TEXTRENDER_RECT_ID, PIXEL_SIZE>& live) const {
+		const auto area = [](const auto& r) {
+			return (int64_t{ r.w } * r.h);
+		};
+		const auto within = [](const PIXEL_LTWH& r, const PIXEL_SIZE& size) {
+			return (
+				(r.left >= 0) && (r.top >= 0) &&
+				((r.left + r.w) <= size.w) && ((r.top + r.h) <= size.h)
+			);
+		};
+		const auto overlap = [](const PIXEL_LTWH& a, const PIXEL_LTWH& b) {
+			return (
+				(a.left < (b.left + b.w)) && (b.left < (a.left + a.w)) &&
+				(a.top < (b.top + b.h)) && (b.top < (a.top + a.h))
+			);
+		};
+
+		std::vector<PIXEL_LTWH> all = spaces;
+		for(const auto& [rect_id, size] : live) {
+			if(
+				(rect_id >= rects.size()) ||
+				!rects[rect_id].live ||
+				(rects[rect_id].rect.w != size.w) ||
+				(rects[rect_id].rect.h != size.h) ||
+				!within(rects[rect_id].rect, bounds)
+			) {
+				return false;
+			}
+			all.emplace_back(rects[rect_id].rect);
+		}
+		if(
+			(std::ranges::count(rects, true, &RECT_AND_CONTENTS::live) !=
+			std::ssize(live)) ||
+			(bounds.w > canvas.w) ||
+			(bounds.h > canvas.h)
+		) {
+			return false;
+		}
+
+		int64_t area_sum = 0;
+		for(size_t i = 0; i < all.size(); i++) {
+			if(!within(all[i], canvas)) {
+				return false;
+			}
+			for(size_t j = (i + 1); j < all.size(); j++) {
+				if(overlap(all[i], all[j])) {
+					return false;
+				}
+			}
+			area_sum += area(all[i]);
+		}
+		return (area_sum == area(canvas));
+	}
+
+	int64_t BoundsArea() const {
+		return (int64_t{ bounds.w } * bounds.h);
+	}
+};
+
+// Random text line sizes, similar to the ones in menus and dialogs.
+static PIXEL_SIZE RandomSize(std::mt19937& rng)
+{
+	return {
+		static_cast<PIXEL_COORD>(8 + (rng() % 313)),
+		static_cast<PIXEL_COORD>(8 + (rng() % 25)),
+	};
+}
+
+// Keeps roughly the same number of rectangles alive while continuously
+// freeing and registering others, like windows that open and close text
+// lines. Checks that the packer stays consistent after every operation, and
+// that freed space is reused rather than growing the surface forever.
+static const TEST TextPackedChurn = { "text_packed/churn", [] {
+	constexpr int OPS = 4000;
+	constexpr size_t LIVE_TARGET = 48;
+
+	std::mt19937 rng{ 0x5EED };
+	TEXTRENDER_PACKED_INSPECT packer;
+	std::map<TEXTRENDER_RECT_ID, PIXEL_SIZE> live;
+	int64_t live_area = 0;
+	int64_t live_area_peak = 0;
+	int64_t bounds_area_peak = 0;
+	for(int op = 0; op < OPS; op++) {
+		const auto free = (!live.empty() && (
+			(live.size() >= (LIVE_TARGET * 2)) ||
+			((rng() % (LIVE_TARGET * 2)) < live.size())
+		));
+		if(free) {
+			auto it = std::next(live.begin(), (rng() % live.size()));
+			packer.Free(it->first);
+			live_area -= (int64_t{ it->second.w } * it->second.h);
+			live.erase(it);
+		} else {
+			const auto size = RandomSize(rng);
+			const auto rect_id = packer.Register(size);
+			if(!TEST_CHECK(!live.contains(rect_id))) {
+				return;
+			}
+			live.emplace(rect_id, size);
+			live_area += (int64_t{ size.w } * size.h);
+		}
+		if(!TEST_CHECK(packer.Valid(live))) {
+			return;
+		}
+		live_area_peak = (std::max)(live_area_peak, live_area);
+		bounds_area_peak = (std::max)(bounds_area_peak, packer.BoundsArea());
+	}
+
+	// Without reuse, the surface would have grown to roughly the total area
+	// of all rectangles ever registered, which is more than 20× the peak live
+	// area.
+	TEST_CHECK(bounds_area_peak <= (live_area_peak * 2));
+
+	// Compacting keeps all IDs and sizes, and never grows the surface.
+	const auto bounds_area = packer.BoundsArea();
+	packer.Compact();
+	TEST_CHECK(packer.Valid(live));
+	TEST_CHECK(packer.BoundsArea() <= bounds_area);
+} };
+
+// Freeing everything and registering the same sizes again must fit into the
+// existing surface.
+static const TEST TextPackedRefill = { "text_packed/refill", [] {
+	std::mt19937 rng{ 0 };
+	TEXTRENDER_PACKED_INSPECT packer;
+	std::map<TEXTRENDER_RECT_ID, PIXEL_SIZE> live;
+	for(int i = 0; i < 32; i++) {
+		const auto size = RandomSize(rng);
+		live.emplace(packer.Register(size), size);
+	}
+	const auto bounds_area = packer.BoundsArea();
+	const auto sizes = live;
+	for(const auto& [rect_id, size] : sizes) {
+		packer.Free(rect_id);
+		live.erase(rect_id);
+		TEST_CHECK(packer.Valid(live));
+	}
+	for(const auto& [rect_id, size] : sizes) {
+		live.emplace(packer.Register(size), size);
+		TEST_CHECK(packer.Valid(live));
+	}
+	TEST_CHECK(packer.BoundsArea() <= bounds_area);
+
+	packer.Clear();
+	live.clear();
+	TEST_CHECK(packer.Valid(live));
+	TEST_CHECK(packer.Generation() == 1);
+} };
+
+// Compares BlitColumns() against the per-column Blit() calls that the wavy
+// music title used to make, pixel by pixel on the software renderer. The
+// columns overlap like in MTitleRenderWave(), and run past the registered
+// rectangle, the edge of the surface, and the edges of the screen.
+static const TEST TextPackedBlitColumns = { "text_packed/blit_columns", [] {
+	constexpr PIXEL_SIZE TEXT_SIZE = { 256, 40 };
+	constexpr PIXEL_COORD COLUMN_W = 2;
+
+	if(!TEST_CHECK(TestGrp_Init())) {
+		return;
+	}
+	defer(TestGrp_Cleanup());
+	if(!TEST_CHECK(TestGrp_SurfaceRandom(SURFACE_ID::TEXT, TEXT_SIZE, 7))) {
+		return;
+	}
+
+	TEXTRENDER_PACKED packer;
+	const auto rect_id = packer.Register({ 200, 20 });
+	packer.Register({ 56, 20 });
+	const auto h = packer.Subrect(rect_id, std::nullopt).h;
+
+	std::mt19937 rng{ 0x3742 };
+	for(const auto left : { -24, 160, 500 }) {
+		std::vector<WINDOW_POINT> columns;
+		for(PIXEL_COORD j = 0; j < (TEXT_SIZE.w + 16); j++) {
+			columns.emplace_back(WINDOW_POINT{
+				(left + j + static_cast<int>(rng() % 9) - 4),
+				(static_cast<int>(rng() % 480) - h),
+			});
+		}
+
+		GrpBackend_Clear();
+		for(PIXEL_COORD j = 0; j < std::ssize(columns); j++) {
+			const PIXEL_LTWH subrect = { j, 0, 1, h };
+			for(PIXEL_COORD k = 0; k < COLUMN_W; k++) {
+				const auto& topleft = columns[j];
+				packer.Blit({ (topleft.x + k), topleft.y }, rect_id, subrect);
+			}
+		}
+		const auto expected = TestGrp_Pixels();
+
+		GrpBackend_Clear();
+		const PIXEL_LTWH subrect = { 0, 0, TEXT_SIZE.w, h };
+		packer.BlitColumns(rect_id, subrect, columns, COLUMN_W);
+		const auto actual = TestGrp_Pixels();
+
+		if(!TEST_CHECK(!expected.empty() && (actual == expected))) {
+			const auto [it_expected, it_actual] = std::ranges::mismatch(
+				expected, actual
+			);
+			if(it_expected != expected.end()) {
+				const auto i = (it_expected - expected.begin());
+				printf(
+					"(%d, %d): 0x%06X (per column) != 0x%06X (strip)\n",
+					static_cast<int>(i % GRP_RES.w),
+					static_cast<int>(i / GRP_RES.w),
+					*it_expected,
+					*it_actual
+				);
+			}
+		}
+	}
+} };
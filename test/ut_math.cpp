@@ -0,0 +1,259 @@
+/*
+ *   Tests for the integer math functions
+ *
+ */
+
+#include "test/test.h"
+#include "game/ut_math.h"
+
+// The entire domain from 0 to (2³¹ - 1) takes ~50 seconds on a single core.
+static const TEST IsqrtExhaustive = { "ut_math/isqrt", [] {
+	constexpr int64_t S_MAX = (std::numeric_limits<int32_t>::max)();
+	const auto failures = Test_ParallelCountFailures(0, S_MAX, [](int64_t s) {
+		const auto expected = std::llround(std::sqrt(double(s)));
+		return (isqrt(static_cast<int32_t>(s)) == expected);
+	});
+	TEST_CHECK(failures == 0);
+	TEST_CHECK(isqrt(-1) == 0);
+	TEST_CHECK(isqrt((std::numeric_limits<int32_t>::min)()) == 0);
+} };
+
+// Reference model of atan8(), written down directly from the definition of
+// ATAN256 and the original 64-bit scaled division.
+static uint8_t Atan8Reference(int x, int y)
+{
+	if((x == 0) && (y == 0)) {
+		return 0x00;
+	}
+	const auto atan_scaled = [](int64_t i) {
+		return std::lround(std::atan(i / 256.0) * (128 / std::numbers::pi));
+	};
+	const auto x_abs = std::abs(int64_t{ x });
+	const auto y_abs = std::abs(int64_t{ y });
+	long ret = 0x20;
+	if(x_abs > y_abs) {
+		ret = atan_scaled((y_abs * 256) / x_abs);
+	} else if(x_abs < y_abs) {
+		ret = (0x40 - atan_scaled((x_abs * 256) / y_abs));
+	}
+	if(x < 0) {
+		ret = (0x80 - ret);
+	}
+	if(y < 0) {
+		ret = -ret;
+	}
+	return static_cast<uint8_t>(ret);
+}
+
+// Also checks that the result stays within one unit of the exact angle, which
+// the table lookup can't guarantee for larger errors.
+static bool Atan8Matches(int x, int y)
+{
+	const auto ret = atan8(x, y);
+	const auto exact = std::lround(
+		std::atan2(double(y), double(x)) * (128 / std::numbers::pi)
+	);
+	const auto diff = static_cast<int8_t>(ret - static_cast<uint8_t>(exact));
+	return ((ret == Atan8Reference(x, y)) && (std::abs(diff) <= 1));
+}
+
+static const TEST Atan8Grid = { "ut_math/atan8", [] {
+	constexpr int64_t RANGE = 1024;
+	constexpr int64_t SIDE = ((RANGE * 2) + 1);
+	constexpr int64_t LAST = ((SIDE * SIDE) - 1);
+	const auto failures = Test_ParallelCountFailures(0, LAST, [](int64_t v) {
+		const auto x = static_cast<int>((v % SIDE) - RANGE);
+		const auto y = static_cast<int>((v / SIDE) - RANGE);
+		return Atan8Matches(x, y);
+	});
+	TEST_CHECK(failures == 0);
+
+	// Extremes, relying on the 64-bit division. INT_MIN is excluded because
+	// abs() of it is undefined.
+	constexpr int MAX = (std::numeric_limits<int>::max)();
+	constexpr int EXTREMES[] = {
+		0, 1, -1, 255, -255, 256, -256, (MAX / 2), -(MAX / 2), MAX, -MAX
+	};
+	for(const auto x : EXTREMES) {
+		for(const auto y : EXTREMES) {
+			TEST_CHECK(Atan8Matches(x, y));
+		}
+	}
+} };
+
+// Batch versions
+// --------------
+
+// Elements per call to a batch function.
+constexpr int64_t BATCH_CHUNK = 4096;
+
+// sinl() and cosl() multiply the table value with [length] in a `long`, which
+// is 32-bit on Windows. Their domain therefore covers every length whose
+// product with 256 still fits into 32 bits.
+constexpr int64_t TRIG_LENGTH_MIN = -(int64_t{ 1 } << 23);
+constexpr int64_t TRIG_LENGTHS = (int64_t{ 1 } << 24);
+constexpr int64_t TRIG_CHUNKS = ((256 * TRIG_LENGTHS) / BATCH_CHUNK);
+
+using TRIG_BATCH_FUNC = void(
+	std::span<int>, std::span<const uint8_t>, std::span<const int>
+);
+
+template <
+	int (*Scalar)(uint8_t, int), TRIG_BATCH_FUNC *Batch
+> static bool TrigBatchMatches(int64_t chunk)
+{
+	const auto first = (chunk * BATCH_CHUNK);
+	const auto deg = static_cast<uint8_t>(first / TRIG_LENGTHS);
+	const auto length_first = ((first % TRIG_LENGTHS) + TRIG_LENGTH_MIN);
+
+	std::array<uint8_t, BATCH_CHUNK> degs;
+	std::array<int, BATCH_CHUNK> lengths;
+	std::array<int, BATCH_CHUNK> ret;
+	degs.fill(deg);
+	for(int64_t i = 0; i < BATCH_CHUNK; i++) {
+		lengths[i] = static_cast<int>(length_first + i);
+	}
+	Batch(ret, degs, lengths);
+	for(int64_t i = 0; i < BATCH_CHUNK; i++) {
+		if(ret[i] != Scalar(deg, lengths[i])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static const TEST SinlBatch = { "ut_math/batch/sinl", [] {
+	const auto failures = Test_ParallelCountFailures(
+		0, (TRIG_CHUNKS - 1), TrigBatchMatches<sinl, sinl_batch>
+	);
+	TEST_CHECK(failures == 0);
+} };
+
+static const TEST CoslBatch = { "ut_math/batch/cosl", [] {
+	const auto failures = Test_ParallelCountFailures(
+		0, (TRIG_CHUNKS - 1), TrigBatchMatches<cosl, cosl_batch>
+	);
+	TEST_CHECK(failures == 0);
+} };
+
+static bool Atan8BatchMatches(std::span<const int> x, std::span<const int> y)
+{
+	std::array<uint8_t, BATCH_CHUNK> ret;
+	const auto ret_span = std::span{ ret }.first(x.size());
+	atan8_batch(ret_span, x, y);
+	for(size_t i = 0; i < x.size(); i++) {
+		if(ret_span[i] != atan8(x[i], y[i])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// atan8() has a 64-bit domain, so this covers every pair of 16-bit
+// coordinates, followed by random pairs and extremes from the full range.
+static const TEST Atan8Batch = { "ut_math/batch/atan8", [] {
+	constexpr int64_t SIDE = 0x10000;
+	constexpr int64_t CHUNKS = ((SIDE * SIDE) / BATCH_CHUNK);
+	const auto failures = Test_ParallelCountFailures(0, (CHUNKS - 1), [](
+		int64_t chunk
+	) {
+		const auto first = (chunk * BATCH_CHUNK);
+		const auto y = static_cast<int>((first / SIDE) - (SIDE / 2));
+		std::array<int, BATCH_CHUNK> xs;
+		std::array<int, BATCH_CHUNK> ys;
+		ys.fill(y);
+		for(int64_t i = 0; i < BATCH_CHUNK; i++) {
+			xs[i] = static_cast<int>(((first + i) % SIDE) - (SIDE / 2));
+		}
+		return Atan8BatchMatches(xs, ys);
+	});
+	TEST_CHECK(failures == 0);
+
+	constexpr int MAX = (std::numeric_limits<int>::max)();
+	std::mt19937 rng{ 0 };
+	std::uniform_int_distribution<int> dist{ -MAX, MAX };
+	std::array<int, BATCH_CHUNK> xs;
+	std::array<int, BATCH_CHUNK> ys;
+	for(int round = 0; round < 1024; round++) {
+		std::ranges::generate(xs, [&] { return dist(rng); });
+		std::ranges::generate(ys, [&] { return dist(rng); });
+		TEST_CHECK(Atan8BatchMatches(xs, ys));
+	}
+
+	constexpr int EXTREMES[] = {
+		0, 1, -1, 255, -255, 256, -256, (MAX / 2), -(MAX / 2), MAX, -MAX
+	};
+	std::vector<int> xs_extreme;
+	std::vector<int> ys_extreme;
+	for(const auto x : EXTREMES) {
+		for(const auto y : EXTREMES) {
+			xs_extreme.emplace_back(x);
+			ys_extreme.emplace_back(y);
+		}
+	}
+	TEST_CHECK(Atan8BatchMatches(xs_extreme, ys_extreme));
+} };
+
+static const TEST BatchBenchmark = { "ut_math/batch/benchmark", [] {
+	using namespace std::chrono;
+
+	constexpr size_t COUNT = (1 << 16);
+	constexpr int ROUNDS = 200;
+	std::mt19937 rng{ 0 };
+	std::vector<uint8_t> degs(COUNT);
+	std::vector<int> lengths(COUNT);
+	std::vector<int> xs(COUNT);
+	std::vector<int> ys(COUNT);
+	std::ranges::generate(degs, [&] { return static_cast<uint8_t>(rng()); });
+	std::ranges::generate(lengths, [&] { return int(rng() % 0x10000); });
+	std::ranges::generate(xs, [&] { return (int(rng() % 0x20000) - 0x10000); });
+	std::ranges::generate(ys, [&] { return (int(rng() % 0x20000) - 0x10000); });
+
+	const auto report = [](const char *func, auto t_scalar, auto t_batch) {
+		const auto us = [](auto t) {
+			const auto ret = duration_cast<microseconds>(t);
+			return static_cast<long long>(ret.count());
+		};
+		printf(
+			"%s: %lld us (scalar) / %lld us (batch)\n",
+			func,
+			us(t_scalar),
+			us(t_batch)
+		);
+	};
+
+	std::vector<int> ret_scalar(COUNT);
+	std::vector<int> ret_batch(COUNT);
+	auto t_start = steady_clock::now();
+	for(int round = 0; round < ROUNDS; round++) {
+		for(size_t i = 0; i < COUNT; i++) {
+			ret_scalar[i] = sinl(degs[i], lengths[i]);
+		}
+	}
+	const auto t_sinl_scalar = (steady_clock::now() - t_start);
+	t_start = steady_clock::now();
+	for(int round = 0; round < ROUNDS; round++) {
+		sinl_batch(ret_batch, degs, lengths);
+	}
+	const auto t_sinl_batch = (steady_clock::now() - t_start);
+	TEST_CHECK(ret_scalar == ret_batch);
+	report("sinl", t_sinl_scalar, t_sinl_batch);
+
+	std::vector<uint8_t> atan_scalar(COUNT);
+	std::vector<uint8_t> atan_batch(COUNT);
+	t_start = steady_clock::now();
+	for(int round = 0; round < ROUNDS; round++) {
+		for(size_t i = 0; i < COUNT; i++) {
+			atan_scalar[i] = atan8(xs[i], ys[i]);
+		}
+	}
+	const auto t_atan8_scalar = (steady_clock::now() - t_start);
+	t_start = steady_clock::now();
+	for(int round = 0; round < ROUNDS; round++) {
+		atan8_batch(atan_batch, xs, ys);
+	}
+	const auto t_atan8_batch = (steady_clock::now() - t_start);
+	TEST_CHECK(atan_scalar == atan_batch);
+	report("atan8", t_atan8_scalar, t_atan8_batch);
+}, true };
+// --------------